@@ -10,85 +10,312 @@
 ****************************************************************************/
 
 #include "bwt.hpp"
+#include "../Suffix Array/suffix_array.hpp"
 #include <algorithm>
+#include <cassert>
 #include <numeric>  // For std::iota
 #include <vector>
 #include <stdexcept>
+#include <cstdint>
+#include <chrono>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace bwt {
 
-constexpr size_t BurrowsWheelerTransform::BLOCK_SIZE;
-std::vector<unsigned char> BurrowsWheelerTransform::block(BLOCK_SIZE);
+namespace {
 
-int BurrowsWheelerTransform::transform(std::ifstream& fpIn, std::ofstream& fpOut, XformMethod method) {
-    if (!fpIn.is_open() || !fpOut.is_open()) {
-        std::cerr << "Invalid file stream provided." << std::endl;
-        return -1;
+constexpr size_t HEADER_SIZE = 4;
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+unsigned char* putLE(unsigned char* dst, size_t value, size_t width) {
+    for (size_t i = 0; i < width; ++i) {
+        dst[i] = static_cast<unsigned char>(value >> (8 * i));
     }
+    return dst + width;
+}
 
-    std::vector<unsigned int> rotationIdx(BLOCK_SIZE);
-    std::vector<unsigned int> v(BLOCK_SIZE);
-    std::vector<unsigned char> last(BLOCK_SIZE);
+size_t getLE(const unsigned char* src, size_t width) {
+    size_t value = 0;
+    for (size_t i = 0; i < width; ++i) {
+        value |= static_cast<size_t>(src[i]) << (8 * i);
+    }
+    return value;
+}
 
-    unsigned int s0Idx;
-    std::array<unsigned int, 256> counters{};
-    std::array<unsigned int, 256> offsetTable{};
+// Indexes and headers are at most four bytes wide
+void writeLE(std::ofstream& fpOut, size_t value, size_t width) {
+    unsigned char bytes[sizeof(uint32_t)];
+    assert(width <= sizeof bytes);
+    width = std::min(width, sizeof bytes);
+    putLE(bytes, value, width);
+    fpOut.write(reinterpret_cast<char*>(bytes), width);
+}
 
-    while (fpIn.read(reinterpret_cast<char*>(block.data()), BLOCK_SIZE)) {
-        size_t blockSize = fpIn.gcount();
+bool readLE(std::ifstream& fpIn, size_t& value, size_t width) {
+    unsigned char bytes[sizeof(uint32_t)];
+    assert(width <= sizeof bytes);
+    width = std::min(width, sizeof bytes);
+    if (!fpIn.read(reinterpret_cast<char*>(bytes), width)) return false;
+    value = getLE(bytes, width);
+    return true;
+}
 
-        counters.fill(0);
-        for (size_t i = 0; i < blockSize; ++i) {
-            counters[block[i]]++;
-        }
+// Position of ch in a 64-byte aligned 256-entry MTF table holding every byte
+// value exactly once.
+size_t findSymbol(const unsigned char* list, unsigned char ch) {
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi8(static_cast<char>(ch));
+    for (size_t i = 0; i < 256; i += 32) {
+        __m256i chunk = _mm256_load_si256(reinterpret_cast<const __m256i*>(list + i));
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+#elif defined(__SSE2__)
+    const __m128i needle = _mm_set1_epi8(static_cast<char>(ch));
+    for (size_t i = 0; i < 256; i += 16) {
+        __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i*>(list + i));
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+#else
+    for (size_t i = 0; i < 256; ++i) {
+        if (list[i] == ch) return i;
+    }
+#endif
+    return 0;
+}
 
-        offsetTable[0] = 0;
-        for (size_t i = 1; i < 256; ++i) {
-            offsetTable[i] = offsetTable[i - 1] + counters[i - 1];
-        }
+// Header word: block size in bits 0-26, decode streams minus one above.
+constexpr size_t BLOCK_SIZE_BITS = 27;
 
-        for (size_t i = 0; i < blockSize - 1; ++i) {
-            unsigned int j = block[i + 1];
-            v[offsetTable[j]++] = i;
-        }
-        v[offsetTable[block[0]]] = blockSize - 1;
+size_t packHeader(size_t blockSize, size_t streams) {
+    return blockSize | ((streams - 1) << BLOCK_SIZE_BITS);
+}
 
-        offsetTable[0] = 0;
-        for (size_t i = 1; i < 256; ++i) {
-            offsetTable[i] = offsetTable[i - 1] + counters[i - 1];
-        }
+bool unpackHeader(size_t word, size_t& blockSize, size_t& streams) {
+    blockSize = word & ((size_t(1) << BLOCK_SIZE_BITS) - 1);
+    streams = (word >> BLOCK_SIZE_BITS) + 1;
+    return blockSize >= BurrowsWheelerTransform::MIN_BLOCK_SIZE &&
+           blockSize <= BurrowsWheelerTransform::MAX_BLOCK_SIZE &&
+           streams <= BurrowsWheelerTransform::MAX_DECODE_STREAMS;
+}
 
-        for (size_t i = 0; i < blockSize; ++i) {
-            unsigned int j = v[i];
-            rotationIdx[offsetTable[block[j]]++] = j;
-        }
+// Segment length when a block of n bytes is split into `streams` chains.
+size_t segmentLength(size_t n, size_t streams) {
+    return (n + streams - 1) / streams;
+}
 
-        for (size_t i = 0, k = 0; (i <= 255) && (k < blockSize - 1); ++i) {
-            for (size_t j = 0; (j <= 255) && (k < blockSize - 1); ++j) {
-                unsigned int first = k;
-                while ((i == block[rotationIdx[k]]) &&
-                       (j == block[(rotationIdx[k] + 1) % blockSize])) {
-                    k++;
-                    if (k == blockSize) break;
-                }
-                if (k - first > 1) {
-                    std::qsort(&rotationIdx[first], k - first, sizeof(int), comparePresorted);
-                }
-            }
+} // namespace
+
+BurrowsWheelerTransform::BurrowsWheelerTransform(size_t blockSize, size_t decodeStreams)
+    : blockSize(blockSize), decodeStreams(decodeStreams) {
+    if (blockSize < MIN_BLOCK_SIZE || blockSize > MAX_BLOCK_SIZE) {
+        throw std::invalid_argument("BWT block size must be between 64 KiB and 64 MiB");
+    }
+    if (decodeStreams == 0 || decodeStreams > MAX_DECODE_STREAMS) {
+        throw std::invalid_argument("BWT decode streams must be between 1 and 8");
+    }
+}
+
+size_t BurrowsWheelerTransform::indexWidth(size_t blockSize) {
+    size_t width = 1;
+    while (width < sizeof(uint32_t) && ((blockSize - 1) >> (8 * width)) != 0) {
+        width++;
+    }
+    return width;
+}
+
+void BurrowsWheelerTransform::writeHeader(std::ofstream& fpOut, size_t blockSize, size_t streams) {
+    writeLE(fpOut, packHeader(blockSize, streams), HEADER_SIZE);
+}
+
+bool BurrowsWheelerTransform::readHeader(std::ifstream& fpIn, size_t& blockSize, size_t& streams) {
+    size_t word;
+    if (!readLE(fpIn, word, HEADER_SIZE) || !unpackHeader(word, blockSize, streams)) {
+        std::cerr << "Invalid BWT stream header." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void BurrowsWheelerTransform::writeIndex(std::ofstream& fpOut, size_t s0Idx, size_t width) {
+    writeLE(fpOut, s0Idx, width);
+}
+
+bool BurrowsWheelerTransform::readIndex(std::ifstream& fpIn, size_t& s0Idx, size_t width) {
+    return readLE(fpIn, s0Idx, width);
+}
+
+size_t BurrowsWheelerTransform::transformBlock(const unsigned char* in, size_t n, unsigned char* out,
+                                               XformMethod method) {
+    size_t s0Idx;
+    return transformBlock(in, n, out, method, &s0Idx, 1);
+}
+
+size_t BurrowsWheelerTransform::transformBlock(const unsigned char* in, size_t n, unsigned char* out,
+                                               XformMethod method, size_t* starts, size_t streams) {
+    if (rotationIdx.size() < n) rotationIdx.resize(n);
+    const Clock::time_point start = Clock::now();
+
+    // Linear time regardless of how repetitive the block is.
+    sa::SuffixArray::sortRotations(in, n, rotationIdx.data());
+    blockStats.sortSeconds += secondsSince(start);
+
+    // Segments that would start past the end of a short block are unused
+    // and recorded as 0.
+    std::fill(starts, starts + streams, 0);
+    const size_t segment = segmentLength(n, streams);
+    for (size_t i = 0; i < n; ++i) {
+        unsigned int r = rotationIdx[i];
+        out[i] = (r != 0) ? in[r - 1] : in[n - 1];
+        if (r % segment == 0) starts[r / segment] = i;
+    }
+
+    if (method != XformMethod::WITHOUT_MTF) {
+        const Clock::time_point mtfStart = Clock::now();
+        if (method == XformMethod::WITH_MTF) {
+            doMTF(out, n);
+        } else {
+            doFastMTF(out, n);
         }
+        blockStats.mtfSeconds += secondsSince(mtfStart);
+    }
+
+    const double seconds = secondsSince(start);
+    const double rate = seconds > 0 ? n / seconds : 0;
+    blockStats.minBlockBytesPerSecond =
+        blockStats.blocks == 0 ? rate : std::min(blockStats.minBlockBytesPerSecond, rate);
+    blockStats.maxBlockBytesPerSecond = std::max(blockStats.maxBlockBytesPerSecond, rate);
+    blockStats.lastBlockBytesPerSecond = rate;
+    blockStats.transformSeconds += seconds;
+    blockStats.blocks++;
+    blockStats.bytes += n;
+    return starts[0];
+}
+
+int BurrowsWheelerTransform::reverseTransformBlock(const unsigned char* in, size_t n, size_t s0Idx,
+                                                   unsigned char* out, XformMethod method) {
+    return reverseTransformBlock(in, n, &s0Idx, 1, out, method);
+}
 
-        s0Idx = 0;
-        for (size_t i = 0; i < blockSize; ++i) {
-            last[i] = (rotationIdx[i] != 0) ? block[rotationIdx[i] - 1] : block[blockSize - 1];
-            if (rotationIdx[i] == 0) s0Idx = i;
+int BurrowsWheelerTransform::reverseTransformBlock(const unsigned char* in, size_t n, const size_t* starts,
+                                                   size_t streams, unsigned char* out, XformMethod method) {
+    const size_t segment = segmentLength(n, streams);
+    for (size_t k = 0; k < streams && k * segment < n; ++k) {
+        if (starts[k] >= n) {
+            std::cerr << "Corrupt BWT block: primary index out of range." << std::endl;
+            return -1;
         }
+    }
+    if (n == 0) {
+        std::cerr << "Corrupt BWT block: primary index out of range." << std::endl;
+        return -1;
+    }
 
-        if (method == XformMethod::WITH_MTF) {
-            if (doMTF(last) != 0) return -1;
+    const Clock::time_point start = Clock::now();
+    if (method != XformMethod::WITHOUT_MTF) {
+        if (mtfScratch.size() < n) mtfScratch.resize(n);
+        std::copy(in, in + n, mtfScratch.begin());
+        int rc = (method == XformMethod::WITH_MTF) ? undoMTF(mtfScratch.data(), n)
+                                                   : undoFastMTF(mtfScratch.data(), n);
+        if (rc != 0) return -1;
+        in = mtfScratch.data();
+        blockStats.mtfSeconds += secondsSince(start);
+    }
+
+    if (n <= (size_t(1) << 24)) {
+        decodeChains(in, n, starts, streams, out, links);
+    } else {
+        decodeChains(in, n, starts, streams, out, wideLinks);
+    }
+    blockStats.reverseSeconds += secondsSince(start);
+    blockStats.reverseBlocks++;
+    blockStats.reverseBytes += n;
+    return 0;
+}
+
+template <class Word>
+void BurrowsWheelerTransform::decodeChains(const unsigned char* in, size_t n, const size_t* starts,
+                                           size_t streams, unsigned char* out, std::vector<Word>& words) {
+    if (words.size() < n) words.resize(n);
+
+    std::array<size_t, 256> count{};
+    for (size_t i = 0; i < n; ++i) {
+        count[in[i]]++;
+    }
+    size_t sum = 0;
+    for (int c = 0; c <= 255; ++c) {
+        size_t tmp = count[c];
+        count[c] = sum;
+        sum += tmp;
+    }
+
+    // Row LF(i) of the first column holds symbol in[i] and links forward to
+    // row i, so one load per output byte yields both the symbol and the next
+    // row to visit.
+    for (size_t i = 0; i < n; ++i) {
+        words[count[in[i]]++] = (static_cast<Word>(i) << 8) | in[i];
+    }
+
+    // Segment k covers text positions [k * segment, (k + 1) * segment) and
+    // starts at row starts[k]. The chains are independent, so their loads
+    // are issued back to back and overlap in the memory system.
+    const size_t segment = segmentLength(n, streams);
+    const size_t active = (n + segment - 1) / segment;
+    const size_t lastLength = n - (active - 1) * segment;
+    std::array<Word, MAX_DECODE_STREAMS> row{};
+    for (size_t k = 0; k < active; ++k) {
+        row[k] = static_cast<Word>(starts[k]);
+    }
+
+    const Word* link = words.data();
+    for (size_t t = 0; t < lastLength; ++t) {
+        for (size_t k = 0; k < active; ++k) {
+            Word w = link[row[k]];
+            out[k * segment + t] = static_cast<unsigned char>(w);
+            row[k] = w >> 8;
         }
+    }
+    for (size_t t = lastLength; t < segment; ++t) {
+        for (size_t k = 0; k + 1 < active; ++k) {
+            Word w = link[row[k]];
+            out[k * segment + t] = static_cast<unsigned char>(w);
+            row[k] = w >> 8;
+        }
+    }
+}
 
-        fpOut.write(reinterpret_cast<char*>(&s0Idx), sizeof(s0Idx));
-        fpOut.write(reinterpret_cast<char*>(last.data()), blockSize);
+int BurrowsWheelerTransform::transform(std::ifstream& fpIn, std::ofstream& fpOut, XformMethod method) {
+    if (!fpIn.is_open() || !fpOut.is_open()) {
+        std::cerr << "Invalid file stream provided." << std::endl;
+        return -1;
+    }
+
+    // Buffers are kept across calls; resize is a no-op after the first one.
+    block.resize(blockSize);
+    last.resize(blockSize);
+
+    const size_t width = indexWidth(blockSize);
+    writeHeader(fpOut, blockSize, decodeStreams);
+
+    std::array<size_t, MAX_DECODE_STREAMS> starts;
+    while (fpIn.read(reinterpret_cast<char*>(block.data()), blockSize) || fpIn.gcount() > 0) {
+        size_t blockLen = fpIn.gcount();
+        transformBlock(block.data(), blockLen, last.data(), method, starts.data(), decodeStreams);
+
+        for (size_t k = 0; k < decodeStreams; ++k) {
+            writeIndex(fpOut, starts[k], width);
+        }
+        fpOut.write(reinterpret_cast<char*>(last.data()), blockLen);
     }
     return 0;
 }
@@ -99,81 +326,170 @@ int BurrowsWheelerTransform::reverseTransform(std::ifstream& fpIn, std::ofstream
         return -1;
     }
 
-    std::vector<int> pred(BLOCK_SIZE);
-    std::vector<unsigned char> unrotated(BLOCK_SIZE);
-    unsigned int s0Idx;
-    std::array<int, 256> count{};
+    // The stream records the block size and stream count it was written
+    // with, which may differ from this instance's.
+    size_t streamBlockSize, streams;
+    if (!readHeader(fpIn, streamBlockSize, streams)) return -1;
 
-    while (fpIn.read(reinterpret_cast<char*>(&s0Idx), sizeof(s0Idx))) {
-        size_t blockSize = fpIn.read(reinterpret_cast<char*>(block.data()), BLOCK_SIZE).gcount();
+    block.resize(std::max(block.size(), streamBlockSize));
+    unrotated.resize(std::max(unrotated.size(), streamBlockSize));
 
-        if (method == XformMethod::WITH_MTF) {
-            if (undoMTF(block) != 0) return -1;
-        }
+    const size_t width = indexWidth(streamBlockSize);
+    std::array<size_t, MAX_DECODE_STREAMS> starts;
 
-        std::fill(count.begin(), count.end(), 0);
-        for (size_t i = 0; i < blockSize; ++i) {
-            pred[i] = count[block[i]]++;
+    while (readIndex(fpIn, starts[0], width)) {
+        for (size_t k = 1; k < streams; ++k) {
+            if (!readIndex(fpIn, starts[k], width)) {
+                std::cerr << "Truncated BWT block." << std::endl;
+                return -1;
+            }
         }
-
-        int sum = 0;
-        for (int i = 0; i <= 255; ++i) {
-            int tmp = count[i];
-            count[i] = sum;
-            sum += tmp;
+        size_t blockLen = fpIn.read(reinterpret_cast<char*>(block.data()), streamBlockSize).gcount();
+        if (reverseTransformBlock(block.data(), blockLen, starts.data(), streams, unrotated.data(), method) != 0) {
+            return -1;
         }
 
-        size_t i = s0Idx;
-        for (size_t j = blockSize; j > 0; --j) {
-            unrotated[j - 1] = block[i];
-            i = pred[i] + count[block[i]];
+        fpOut.write(reinterpret_cast<char*>(unrotated.data()), blockLen);
+    }
+    return 0;
+}
+
+size_t BurrowsWheelerTransform::transformedSize(size_t n) const {
+    size_t blocks = (n + blockSize - 1) / blockSize;
+    return HEADER_SIZE + blocks * decodeStreams * indexWidth(blockSize) + n;
+}
+
+long BurrowsWheelerTransform::originalSize(const unsigned char* stream, size_t n) {
+    size_t streamBlockSize, streams;
+    if (n < HEADER_SIZE || !unpackHeader(getLE(stream, HEADER_SIZE), streamBlockSize, streams)) return -1;
+
+    size_t indexBytes = streams * indexWidth(streamBlockSize);
+    size_t body = n - HEADER_SIZE;
+    size_t blocks = (body + streamBlockSize + indexBytes - 1) / (streamBlockSize + indexBytes);
+    if (blocks * indexBytes > body) return -1;
+    return static_cast<long>(body - blocks * indexBytes);
+}
+
+long BurrowsWheelerTransform::transform(const unsigned char* in, size_t n, unsigned char* out,
+                                        size_t outCapacity, XformMethod method) {
+    if (outCapacity < transformedSize(n)) {
+        std::cerr << "Output buffer too small for BWT stream." << std::endl;
+        return -1;
+    }
+
+    const size_t width = indexWidth(blockSize);
+    const size_t indexBytes = decodeStreams * width;
+    std::array<size_t, MAX_DECODE_STREAMS> starts;
+    unsigned char* dst = putLE(out, packHeader(blockSize, decodeStreams), HEADER_SIZE);
+    for (size_t offset = 0; offset < n; offset += blockSize) {
+        size_t blockLen = std::min(blockSize, n - offset);
+        transformBlock(in + offset, blockLen, dst + indexBytes, method, starts.data(), decodeStreams);
+        for (size_t k = 0; k < decodeStreams; ++k) {
+            putLE(dst + k * width, starts[k], width);
         }
+        dst += indexBytes + blockLen;
+    }
+    return static_cast<long>(dst - out);
+}
 
-        fpOut.write(reinterpret_cast<char*>(unrotated.data()), blockSize);
+long BurrowsWheelerTransform::reverseTransform(const unsigned char* in, size_t n, unsigned char* out,
+                                               size_t outCapacity, XformMethod method) {
+    long total = originalSize(in, n);
+    if (total < 0) {
+        std::cerr << "Invalid BWT stream header." << std::endl;
+        return -1;
     }
-    return 0;
+    if (outCapacity < static_cast<size_t>(total)) {
+        std::cerr << "Output buffer too small for restored data." << std::endl;
+        return -1;
+    }
+
+    size_t streamBlockSize, streams;
+    unpackHeader(getLE(in, HEADER_SIZE), streamBlockSize, streams);
+    const size_t width = indexWidth(streamBlockSize);
+    const size_t indexBytes = streams * width;
+    std::array<size_t, MAX_DECODE_STREAMS> starts;
+    const unsigned char* src = in + HEADER_SIZE;
+    const unsigned char* end = in + n;
+    unsigned char* dst = out;
+    while (src < end) {
+        if (static_cast<size_t>(end - src) <= indexBytes) {
+            std::cerr << "Truncated BWT block." << std::endl;
+            return -1;
+        }
+        for (size_t k = 0; k < streams; ++k) {
+            starts[k] = getLE(src + k * width, width);
+        }
+        src += indexBytes;
+        size_t blockLen = std::min(streamBlockSize, static_cast<size_t>(end - src));
+        if (reverseTransformBlock(src, blockLen, starts.data(), streams, dst, method) != 0) return -1;
+        src += blockLen;
+        dst += blockLen;
+    }
+    return static_cast<long>(dst - out);
 }
 
-int BurrowsWheelerTransform::doMTF(std::vector<unsigned char>& last) {
-    std::vector<unsigned char> list(256);
+int BurrowsWheelerTransform::doMTF(unsigned char* last, size_t n) {
+    std::array<unsigned char, 256> list;
     std::iota(list.begin(), list.end(), 0);
 
-    for (size_t i = 0; i < last.size(); ++i) {
-        auto it = std::find(list.begin(), list.end(), last[i]);
-        int idx = std::distance(list.begin(), it);
-        last[i] = static_cast<unsigned char>(idx);
-        list.erase(it);
-        list.insert(list.begin(), last[i]);
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char ch = last[i];
+        auto it = std::find(list.begin(), list.end(), ch);
+        last[i] = static_cast<unsigned char>(std::distance(list.begin(), it));
+        std::copy_backward(list.begin(), it, it + 1);
+        list[0] = ch;
     }
     return 0;
 }
 
-int BurrowsWheelerTransform::undoMTF(std::vector<unsigned char>& last) {
-    std::vector<unsigned char> list(256);
+int BurrowsWheelerTransform::undoMTF(unsigned char* last, size_t n) {
+    std::array<unsigned char, 256> list;
     std::iota(list.begin(), list.end(), 0);
 
-    for (size_t i = 0; i < last.size(); ++i) {
-        unsigned char ch = list[last[i]];
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char idx = last[i];
+        unsigned char ch = list[idx];
         last[i] = ch;
-        list.erase(list.begin() + last[i]);
-        list.insert(list.begin(), ch);
+        std::copy_backward(list.begin(), list.begin() + idx, list.begin() + idx + 1);
+        list[0] = ch;
     }
     return 0;
 }
 
-int BurrowsWheelerTransform::comparePresorted(const void* s1, const void* s2) {
-    unsigned int offset1 = *reinterpret_cast<const unsigned int*>(s1) + 2;
-    unsigned int offset2 = *reinterpret_cast<const unsigned int*>(s2) + 2;
+int BurrowsWheelerTransform::doFastMTF(unsigned char* last, size_t n) {
+    alignas(64) unsigned char list[256];
+    for (int i = 0; i < 256; ++i) list[i] = static_cast<unsigned char>(i);
 
-    for (size_t i = 2; i < block.size(); ++i) {
-        unsigned char c1 = block[offset1 % block.size()];
-        unsigned char c2 = block[offset2 % block.size()];
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char ch = last[i];
+        // Runs are common after the BWT; the front symbol needs no shift.
+        if (list[0] == ch) {
+            last[i] = 0;
+            continue;
+        }
+        size_t idx = findSymbol(list, ch);
+        last[i] = static_cast<unsigned char>(idx);
+        std::memmove(list + 1, list, idx);
+        list[0] = ch;
+    }
+    return 0;
+}
 
-        if (c1 != c2) return (c1 > c2) ? 1 : -1;
-        offset1++;
-        offset2++;
+int BurrowsWheelerTransform::undoFastMTF(unsigned char* last, size_t n) {
+    alignas(64) unsigned char list[256];
+    for (int i = 0; i < 256; ++i) list[i] = static_cast<unsigned char>(i);
+
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char idx = last[i];
+        unsigned char ch = list[idx];
+        last[i] = ch;
+        if (idx != 0) {
+            std::memmove(list + 1, list, idx);
+            list[0] = ch;
+        }
     }
     return 0;
 }
 
-} // namespace bwt
\ No newline at end of file
+} // namespace bwt
@@ -7,31 +7,153 @@
 #include <array>
 #include <cstring>
 #include <iostream>
+#include <cstdint>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
 
 namespace bwt {
 
+// WITH_FAST_MTF produces exactly the same bytes as WITH_MTF, so streams
+// written with one can be read back with the other.
 enum class XformMethod {
     WITHOUT_MTF = 0,
-    WITH_MTF = 1
+    WITH_MTF = 1,
+    WITH_FAST_MTF = 2
+};
+
+// Timings of the block transforms run by one BurrowsWheelerTransform.
+// Throughputs are bytes per second of the whole block transform.
+struct BwtStats {
+    uint64_t blocks = 0;
+    uint64_t bytes = 0;
+    double sortSeconds = 0;
+    double mtfSeconds = 0;        // Move-to-front coding, both directions
+    double transformSeconds = 0;  // Whole forward transforms, sort and MTF included
+    double minBlockBytesPerSecond = 0;
+    double maxBlockBytesPerSecond = 0;
+    double lastBlockBytesPerSecond = 0;
+    uint64_t reverseBlocks = 0;
+    uint64_t reverseBytes = 0;
+    double reverseSeconds = 0;    // Whole inverse transforms, MTF included
+
+    double bytesPerSecond() const { return transformSeconds > 0 ? bytes / transformSeconds : 0; }
+    double reverseBytesPerSecond() const { return reverseSeconds > 0 ? reverseBytes / reverseSeconds : 0; }
 };
 
 class BurrowsWheelerTransform {
 public:
-    static int transform(std::ifstream& fpIn, std::ofstream& fpOut, XformMethod method);
-    static int reverseTransform(std::ifstream& fpIn, std::ofstream& fpOut, XformMethod method);
+    // Block sizes accepted by the constructor. Larger blocks compress
+    // better at the cost of about 10 bytes of working memory per byte.
+    static constexpr size_t MIN_BLOCK_SIZE = 64 * 1024;
+    static constexpr size_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 900 * 1024;
+
+    // Each block records where this many evenly spaced segments of the text
+    // start, so the inverse can follow that many independent LF chains at
+    // once and overlap their cache misses.
+    static constexpr size_t MAX_DECODE_STREAMS = 8;
+    static constexpr size_t DEFAULT_DECODE_STREAMS = 8;
+
+    // Each instance owns its scratch buffers, so separate instances can be
+    // used from separate threads. Throws std::invalid_argument when blockSize
+    // is outside [MIN_BLOCK_SIZE, MAX_BLOCK_SIZE] or decodeStreams is outside
+    // [1, MAX_DECODE_STREAMS].
+    explicit BurrowsWheelerTransform(size_t blockSize = DEFAULT_BLOCK_SIZE,
+                                     size_t decodeStreams = DEFAULT_DECODE_STREAMS);
+
+    // The output starts with a 4 byte little endian header holding the block
+    // size in bits 0-26 and the number of decode streams minus one in bits
+    // 27-29. Every block is then stored as one index per decode stream, each
+    // indexWidth(blockSize) bytes, followed by the transformed bytes. The
+    // first index is the primary index.
+    int transform(std::ifstream& fpIn, std::ofstream& fpOut, XformMethod method);
+    int reverseTransform(std::ifstream& fpIn, std::ofstream& fpOut, XformMethod method);
+
+    // In-memory variants producing the same stream format. Blocks are read
+    // from in and written to out directly, without staging copies. Return
+    // the number of bytes written, or -1 if out is smaller than
+    // transformedSize() / originalSize() or the input is corrupt.
+    long transform(const unsigned char* in, size_t n, unsigned char* out, size_t outCapacity,
+                   XformMethod method);
+    long reverseTransform(const unsigned char* in, size_t n, unsigned char* out, size_t outCapacity,
+                          XformMethod method);
+
+#if __cplusplus >= 202002L
+    long transform(std::span<const std::byte> in, std::span<std::byte> out, XformMethod method) {
+        return transform(reinterpret_cast<const unsigned char*>(in.data()), in.size(),
+                         reinterpret_cast<unsigned char*>(out.data()), out.size(), method);
+    }
+    long reverseTransform(std::span<const std::byte> in, std::span<std::byte> out, XformMethod method) {
+        return reverseTransform(reinterpret_cast<const unsigned char*>(in.data()), in.size(),
+                                reinterpret_cast<unsigned char*>(out.data()), out.size(), method);
+    }
+#endif
+
+    // Exact size of the stream transform() writes for n input bytes.
+    size_t transformedSize(size_t n) const;
+    // Size of the data encoded in stream[0..n), or -1 for a bad header.
+    static long originalSize(const unsigned char* stream, size_t n);
+
+    // Single block entry points used by the stream drivers. in and out must
+    // not overlap and n must not exceed MAX_BLOCK_SIZE. transformBlock
+    // returns the primary index and, in the second form, stores the start
+    // row of each of `streams` segments in starts (starts[0] is the primary
+    // index). reverseTransformBlock returns 0 on success and -1 if an index
+    // is out of range.
+    size_t transformBlock(const unsigned char* in, size_t n, unsigned char* out, XformMethod method);
+    size_t transformBlock(const unsigned char* in, size_t n, unsigned char* out, XformMethod method,
+                          size_t* starts, size_t streams);
+    int reverseTransformBlock(const unsigned char* in, size_t n, size_t s0Idx,
+                              unsigned char* out, XformMethod method);
+    int reverseTransformBlock(const unsigned char* in, size_t n, const size_t* starts, size_t streams,
+                              unsigned char* out, XformMethod method);
+
+    // Timings of every block this instance transformed. Unlike the
+    // counters of the template structures these are always collected: a
+    // few clock reads per block of at least 64 KiB cost nothing measurable.
+    const BwtStats& stats() const { return blockStats; }
+    void resetStats() { blockStats = BwtStats{}; }
+
+    size_t getBlockSize() const { return blockSize; }
+    size_t getDecodeStreams() const { return decodeStreams; }
+
+    // Number of bytes needed to store a primary index for the block size.
+    static size_t indexWidth(size_t blockSize);
+
+    // Stream framing shared with ParallelBurrowsWheelerTransform.
+    static void writeHeader(std::ofstream& fpOut, size_t blockSize, size_t streams);
+    static bool readHeader(std::ifstream& fpIn, size_t& blockSize, size_t& streams);
+    static void writeIndex(std::ofstream& fpOut, size_t s0Idx, size_t width);
+    static bool readIndex(std::ifstream& fpIn, size_t& s0Idx, size_t width);
 
 private:
-    static int doMTF(std::vector<unsigned char>& last);
-    static int undoMTF(std::vector<unsigned char>& last);
+    static int doMTF(unsigned char* last, size_t n);
+    static int undoMTF(unsigned char* last, size_t n);
+    // Vectorized search on an aligned table; repeated symbols skip the shift.
+    static int doFastMTF(unsigned char* last, size_t n);
+    static int undoFastMTF(unsigned char* last, size_t n);
 
-    static int comparePresorted(const void* s1, const void* s2);
+    // Packed (LF link << 8 | symbol) words for the inverse; 32 bits hold
+    // the link for blocks up to 16 MiB, larger blocks use 64-bit words.
+    template <class Word>
+    void decodeChains(const unsigned char* in, size_t n, const size_t* starts, size_t streams,
+                       unsigned char* out, std::vector<Word>& links);
 
-    static constexpr size_t BLOCK_SIZE = 4096;
-    static inline std::vector<unsigned char> block;
+    size_t blockSize;
+    size_t decodeStreams;
+    std::vector<unsigned char> block;
+    std::vector<unsigned int> rotationIdx;
+    std::vector<unsigned char> last;
+    std::vector<uint32_t> links;
+    std::vector<uint64_t> wideLinks;
+    std::vector<unsigned char> unrotated;
+    std::vector<unsigned char> mtfScratch;
+    BwtStats blockStats;
 };
 
 } // namespace bwt
 
-#endif  
+#endif
 
 // Note: This file + cpp is inspired by Michael Dipperstein's implementation in C
\ No newline at end of file
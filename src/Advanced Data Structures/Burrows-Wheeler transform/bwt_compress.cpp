@@ -0,0 +1,428 @@
+/***************************************************************************
+*               Block Compressor for Burrows-Wheeler Transform Library
+*
+*   File    : bwt_compress.cpp
+*   Purpose : Entropy codes BWT + MTF output with zero-run RLE and canonical
+*             Huffman codes into framed, checksummed blocks.
+*   Date    : October 28, 2024
+*
+****************************************************************************/
+
+#include "bwt_compress.hpp"
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+namespace bwt {
+
+namespace {
+
+// Symbol alphabet after run-length coding: two run digits for zero runs,
+// MTF values 1..255 shifted up by one and an end-of-block marker.
+constexpr uint16_t RUNA = 0;
+constexpr uint16_t RUNB = 1;
+constexpr uint16_t EOB = 257;
+constexpr size_t ALPHABET = 258;
+
+// Short enough for a single 8 KiB decode table that stays in L1.
+constexpr unsigned MAX_CODE_LENGTH = 12;
+constexpr size_t LENGTHS_SIZE = (ALPHABET + 1) / 2;
+
+const unsigned char MAGIC[4] = {'B', 'W', 'T', 'Z'};
+
+void putLE32(std::vector<unsigned char>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+uint32_t getLE32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// Huffman code lengths for freq, at most MAX_CODE_LENGTH bits. When the
+// optimal tree is too deep the counts are flattened and the tree rebuilt,
+// as bzip2 does.
+std::array<unsigned char, ALPHABET> buildLengths(std::array<uint32_t, ALPHABET> freq) {
+    std::array<unsigned char, ALPHABET> lengths{};
+    for (;;) {
+        std::vector<uint64_t> weight;
+        std::vector<int> parent;
+        using Entry = std::pair<uint64_t, int>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+        std::array<int, ALPHABET> leaf;
+        leaf.fill(-1);
+        for (size_t s = 0; s < ALPHABET; ++s) {
+            if (freq[s] == 0) continue;
+            leaf[s] = static_cast<int>(weight.size());
+            heap.push({freq[s], leaf[s]});
+            weight.push_back(freq[s]);
+            parent.push_back(-1);
+        }
+        if (weight.size() == 1) {
+            for (size_t s = 0; s < ALPHABET; ++s) {
+                lengths[s] = (leaf[s] >= 0) ? 1 : 0;
+            }
+            return lengths;
+        }
+        while (heap.size() > 1) {
+            Entry a = heap.top();
+            heap.pop();
+            Entry b = heap.top();
+            heap.pop();
+            int node = static_cast<int>(weight.size());
+            weight.push_back(a.first + b.first);
+            parent.push_back(-1);
+            parent[a.second] = node;
+            parent[b.second] = node;
+            heap.push({a.first + b.first, node});
+        }
+
+        unsigned maxLength = 0;
+        for (size_t s = 0; s < ALPHABET; ++s) {
+            unsigned depth = 0;
+            for (int v = leaf[s]; v >= 0 && parent[v] >= 0; v = parent[v]) depth++;
+            lengths[s] = static_cast<unsigned char>(depth);
+            maxLength = std::max(maxLength, depth);
+        }
+        if (maxLength <= MAX_CODE_LENGTH) return lengths;
+
+        for (auto& f : freq) {
+            if (f != 0) f = 1 + f / 2;
+        }
+    }
+}
+
+// Canonical codes assigned in (length, symbol) order, bit-reversed because
+// the bit stream is packed least significant bit first.
+std::array<uint16_t, ALPHABET> buildCodes(const std::array<unsigned char, ALPHABET>& lengths) {
+    std::array<uint16_t, MAX_CODE_LENGTH + 2> next{};
+    std::array<uint16_t, MAX_CODE_LENGTH + 1> count{};
+    for (unsigned char len : lengths) count[len]++;
+    count[0] = 0;
+    uint16_t code = 0;
+    for (unsigned len = 1; len <= MAX_CODE_LENGTH; ++len) {
+        code = static_cast<uint16_t>((code + count[len - 1]) << 1);
+        next[len] = code;
+    }
+
+    std::array<uint16_t, ALPHABET> codes{};
+    for (size_t s = 0; s < ALPHABET; ++s) {
+        unsigned len = lengths[s];
+        if (len == 0) continue;
+        uint16_t c = next[len]++;
+        uint16_t reversed = 0;
+        for (unsigned i = 0; i < len; ++i) {
+            reversed = static_cast<uint16_t>((reversed << 1) | ((c >> i) & 1));
+        }
+        codes[s] = reversed;
+    }
+    return codes;
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<unsigned char>& out) : out(out) {}
+
+    void put(uint32_t bits, unsigned count) {
+        acc |= static_cast<uint64_t>(bits) << used;
+        used += count;
+        while (used >= 8) {
+            out.push_back(static_cast<unsigned char>(acc));
+            acc >>= 8;
+            used -= 8;
+        }
+    }
+
+    void flush() {
+        if (used > 0) out.push_back(static_cast<unsigned char>(acc));
+        acc = 0;
+        used = 0;
+    }
+
+private:
+    std::vector<unsigned char>& out;
+    uint64_t acc = 0;
+    unsigned used = 0;
+};
+
+class BitReader {
+public:
+    BitReader(const unsigned char* p, size_t n) : p(p), n(n) {}
+
+    // Past the end of the payload the reader supplies zero bits; overrun()
+    // reports whether any of them were consumed.
+    uint32_t peek(unsigned count) {
+        while (used <= 56) {
+            uint64_t byte = (pos < n) ? p[pos] : 0;
+            ++pos;
+            acc |= byte << used;
+            used += 8;
+        }
+        return static_cast<uint32_t>(acc & ((1u << count) - 1));
+    }
+
+    void consume(unsigned count) {
+        acc >>= count;
+        used -= count;
+    }
+
+    bool overrun() const { return 8 * pos - used > 8 * n; }
+
+private:
+    const unsigned char* p;
+    size_t n;
+    size_t pos = 0;
+    uint64_t acc = 0;
+    unsigned used = 0;
+};
+
+std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+} // namespace
+
+Compressor::Compressor(size_t blockSize) : xform(blockSize) {}
+
+uint32_t Compressor::crc32(const unsigned char* data, size_t n) {
+    static const std::array<uint32_t, 256> table = makeCrcTable();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+bool Compressor::parseHeader(const unsigned char* p, size_t n, BlockHeader& header) {
+    if (n < HEADER_SIZE || !std::equal(MAGIC, MAGIC + 4, p)) return false;
+    if (p[4] > static_cast<unsigned char>(Codec::HUFFMAN)) return false;
+    header.codec = static_cast<Codec>(p[4]);
+    header.blockSize = getLE32(p + 5);
+    header.primaryIndex = getLE32(p + 9);
+    header.payloadSize = getLE32(p + 13);
+    header.crc = getLE32(p + 17);
+    if (header.blockSize == 0 || header.blockSize > BurrowsWheelerTransform::MAX_BLOCK_SIZE) return false;
+    if (header.codec == Codec::STORED) return header.payloadSize == header.blockSize;
+    return header.primaryIndex < header.blockSize;
+}
+
+void Compressor::compressBlock(const unsigned char* in, size_t n, std::vector<unsigned char>& frame) {
+    if (n == 0) return;
+
+    mtf.resize(n);
+    size_t s0Idx = xform.transformBlock(in, n, mtf.data(), XformMethod::WITH_FAST_MTF);
+
+    // Zero runs become bijective base-2 numbers over RUNA/RUNB (bzip2).
+    symbols.clear();
+    std::array<uint32_t, ALPHABET> freq{};
+    auto emit = [&](uint16_t s) {
+        symbols.push_back(s);
+        freq[s]++;
+    };
+    size_t run = 0;
+    for (size_t i = 0; i <= n; ++i) {
+        if (i < n && mtf[i] == 0) {
+            run++;
+            continue;
+        }
+        if (run > 0) {
+            run--;
+            for (;;) {
+                emit((run & 1) ? RUNB : RUNA);
+                if (run < 2) break;
+                run = (run - 2) / 2;
+            }
+            run = 0;
+        }
+        if (i < n) emit(static_cast<uint16_t>(mtf[i] + 1));
+    }
+    emit(EOB);
+
+    auto lengths = buildLengths(freq);
+    auto codes = buildCodes(lengths);
+
+    uint64_t bits = 0;
+    for (size_t s = 0; s < ALPHABET; ++s) bits += static_cast<uint64_t>(freq[s]) * lengths[s];
+    size_t codedSize = LENGTHS_SIZE + static_cast<size_t>((bits + 7) / 8);
+    Codec codec = (codedSize < n) ? Codec::HUFFMAN : Codec::STORED;
+
+    size_t start = frame.size();
+    frame.insert(frame.end(), MAGIC, MAGIC + 4);
+    frame.push_back(static_cast<unsigned char>(codec));
+    putLE32(frame, static_cast<uint32_t>(n));
+    putLE32(frame, codec == Codec::HUFFMAN ? static_cast<uint32_t>(s0Idx) : 0);
+    putLE32(frame, 0);  // Payload size, patched below
+    putLE32(frame, crc32(in, n));
+    size_t payloadStart = frame.size();
+
+    if (codec == Codec::STORED) {
+        frame.insert(frame.end(), in, in + n);
+    } else {
+        for (size_t s = 0; s < ALPHABET; s += 2) {
+            unsigned char hi = (s + 1 < ALPHABET) ? lengths[s + 1] : 0;
+            frame.push_back(static_cast<unsigned char>(lengths[s] | (hi << 4)));
+        }
+        BitWriter writer(frame);
+        for (uint16_t s : symbols) writer.put(codes[s], lengths[s]);
+        writer.flush();
+    }
+
+    uint32_t payloadSize = static_cast<uint32_t>(frame.size() - payloadStart);
+    for (int i = 0; i < 4; ++i) {
+        frame[start + 13 + i] = static_cast<unsigned char>(payloadSize >> (8 * i));
+    }
+}
+
+long Compressor::decompressBlock(const unsigned char* frame, size_t n, std::vector<unsigned char>& out) {
+    BlockHeader header;
+    if (!parseHeader(frame, n, header)) {
+        std::cerr << "Invalid BWT frame header." << std::endl;
+        return -1;
+    }
+    if (n - HEADER_SIZE < header.payloadSize) {
+        std::cerr << "Truncated BWT frame." << std::endl;
+        return -1;
+    }
+    const unsigned char* payload = frame + HEADER_SIZE;
+    const size_t blockLen = header.blockSize;
+    out.resize(blockLen);
+
+    if (header.codec == Codec::STORED) {
+        std::copy(payload, payload + blockLen, out.begin());
+    } else {
+        if (header.payloadSize < LENGTHS_SIZE) {
+            std::cerr << "Corrupt BWT frame: missing code lengths." << std::endl;
+            return -1;
+        }
+        std::array<unsigned char, ALPHABET> lengths{};
+        uint32_t kraft = 0;
+        for (size_t s = 0; s < ALPHABET; ++s) {
+            unsigned char len = (payload[s / 2] >> ((s & 1) * 4)) & 0x0F;
+            if (len > MAX_CODE_LENGTH) {
+                std::cerr << "Corrupt BWT frame: bad code length." << std::endl;
+                return -1;
+            }
+            lengths[s] = len;
+            if (len != 0) kraft += 1u << (MAX_CODE_LENGTH - len);
+        }
+        if (kraft > (1u << MAX_CODE_LENGTH)) {
+            std::cerr << "Corrupt BWT frame: oversubscribed code." << std::endl;
+            return -1;
+        }
+
+        // Each entry packs symbol (9 bits) and code length (4 bits); a zero
+        // length marks a bit pattern no code maps to.
+        auto codes = buildCodes(lengths);
+        std::vector<uint16_t> table(1u << MAX_CODE_LENGTH, 0);
+        for (size_t s = 0; s < ALPHABET; ++s) {
+            unsigned len = lengths[s];
+            if (len == 0) continue;
+            for (uint32_t fill = codes[s]; fill < table.size(); fill += 1u << len) {
+                table[fill] = static_cast<uint16_t>(s | (len << 9));
+            }
+        }
+
+        BitReader reader(payload + LENGTHS_SIZE, header.payloadSize - LENGTHS_SIZE);
+        mtf.resize(blockLen);
+        size_t pos = 0;
+        size_t run = 0, runWeight = 1;
+        for (;;) {
+            uint16_t entry = table[reader.peek(MAX_CODE_LENGTH)];
+            unsigned len = entry >> 9;
+            uint16_t s = entry & 0x1FF;
+            if (len == 0 || reader.overrun()) {
+                std::cerr << "Corrupt BWT frame: bad code." << std::endl;
+                return -1;
+            }
+            reader.consume(len);
+
+            if (s == RUNA || s == RUNB) {
+                run += (s == RUNA ? 1 : 2) * runWeight;
+                runWeight <<= 1;
+                if (run > blockLen - pos) {
+                    std::cerr << "Corrupt BWT frame: run overflows block." << std::endl;
+                    return -1;
+                }
+                continue;
+            }
+            std::fill(mtf.begin() + pos, mtf.begin() + pos + run, 0);
+            pos += run;
+            run = 0;
+            runWeight = 1;
+            if (s == EOB) break;
+            if (pos == blockLen) {
+                std::cerr << "Corrupt BWT frame: data overflows block." << std::endl;
+                return -1;
+            }
+            mtf[pos++] = static_cast<unsigned char>(s - 1);
+        }
+        if (pos != blockLen || reader.overrun()) {
+            std::cerr << "Corrupt BWT frame: length mismatch." << std::endl;
+            return -1;
+        }
+
+        if (xform.reverseTransformBlock(mtf.data(), blockLen, header.primaryIndex, out.data(),
+                                        XformMethod::WITH_FAST_MTF) != 0) {
+            return -1;
+        }
+    }
+
+    if (crc32(out.data(), blockLen) != header.crc) {
+        std::cerr << "BWT frame failed CRC check." << std::endl;
+        return -1;
+    }
+    return static_cast<long>(HEADER_SIZE + header.payloadSize);
+}
+
+int Compressor::compress(std::ifstream& fpIn, std::ofstream& fpOut) {
+    if (!fpIn.is_open() || !fpOut.is_open()) {
+        std::cerr << "Invalid file stream provided." << std::endl;
+        return -1;
+    }
+
+    const size_t blockSize = xform.getBlockSize();
+    std::vector<unsigned char> block(blockSize);
+    while (fpIn.read(reinterpret_cast<char*>(block.data()), blockSize) || fpIn.gcount() > 0) {
+        frameBuffer.clear();
+        compressBlock(block.data(), fpIn.gcount(), frameBuffer);
+        fpOut.write(reinterpret_cast<char*>(frameBuffer.data()), frameBuffer.size());
+    }
+    return fpOut.good() ? 0 : -1;
+}
+
+int Compressor::decompress(std::ifstream& fpIn, std::ofstream& fpOut) {
+    if (!fpIn.is_open() || !fpOut.is_open()) {
+        std::cerr << "Invalid file stream provided." << std::endl;
+        return -1;
+    }
+
+    std::vector<unsigned char> out;
+    for (;;) {
+        frameBuffer.resize(HEADER_SIZE);
+        fpIn.read(reinterpret_cast<char*>(frameBuffer.data()), HEADER_SIZE);
+        if (fpIn.gcount() == 0) break;
+
+        BlockHeader header;
+        if (!parseHeader(frameBuffer.data(), fpIn.gcount(), header)) {
+            std::cerr << "Invalid BWT frame header." << std::endl;
+            return -1;
+        }
+        frameBuffer.resize(HEADER_SIZE + header.payloadSize);
+        fpIn.read(reinterpret_cast<char*>(frameBuffer.data() + HEADER_SIZE), header.payloadSize);
+        if (decompressBlock(frameBuffer.data(), HEADER_SIZE + fpIn.gcount(), out) < 0) return -1;
+        fpOut.write(reinterpret_cast<char*>(out.data()), out.size());
+    }
+    return fpOut.good() ? 0 : -1;
+}
+
+} // namespace bwt
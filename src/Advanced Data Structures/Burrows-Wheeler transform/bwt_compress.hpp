@@ -0,0 +1,64 @@
+#ifndef BWT_COMPRESS_HPP
+#define BWT_COMPRESS_HPP
+
+#include "bwt.hpp"
+#include <cstdint>
+
+namespace bwt {
+
+enum class Codec : uint8_t {
+    STORED = 0,    // Payload is the original block, used when coding does not help
+    HUFFMAN = 1    // BWT + MTF + zero-run RLE + canonical Huffman
+};
+
+// Every block is written as a self-contained frame:
+//
+//   offset  size  field
+//        0     4  magic "BWTZ"
+//        4     1  codec
+//        5     4  original block length
+//        9     4  primary index
+//       13     4  payload length
+//       17     4  CRC-32 of the original block
+//       21     -  payload
+//
+// All integers are little endian. A reader can skip from frame to frame by
+// payload length and decode any frame on its own.
+struct BlockHeader {
+    Codec codec;
+    uint32_t blockSize;
+    uint32_t primaryIndex;
+    uint32_t payloadSize;
+    uint32_t crc;
+};
+
+class Compressor {
+public:
+    static constexpr size_t HEADER_SIZE = 21;
+
+    // Throws std::invalid_argument for an unsupported block size.
+    explicit Compressor(size_t blockSize = BurrowsWheelerTransform::DEFAULT_BLOCK_SIZE);
+
+    int compress(std::ifstream& fpIn, std::ofstream& fpOut);
+    int decompress(std::ifstream& fpIn, std::ofstream& fpOut);
+
+    // Appends the frame for in[0..n) to frame.
+    void compressBlock(const unsigned char* in, size_t n, std::vector<unsigned char>& frame);
+    // Decodes the frame at frame[0..n) into out. Returns the number of bytes
+    // of frame consumed, or -1 if the frame is truncated or corrupt.
+    long decompressBlock(const unsigned char* frame, size_t n, std::vector<unsigned char>& out);
+
+    // Returns false if p[0..n) does not start with a valid frame header.
+    static bool parseHeader(const unsigned char* p, size_t n, BlockHeader& header);
+    static uint32_t crc32(const unsigned char* data, size_t n);
+
+private:
+    BurrowsWheelerTransform xform;
+    std::vector<unsigned char> mtf;
+    std::vector<uint16_t> symbols;
+    std::vector<unsigned char> frameBuffer;
+};
+
+} // namespace bwt
+
+#endif // BWT_COMPRESS_HPP
@@ -0,0 +1,134 @@
+/***************************************************************************
+*           Memory-Mapped File Driver for Burrows-Wheeler Transform Library
+*
+*   File    : bwt_mmap.cpp
+*   Purpose : Maps input and output files and transforms between the two
+*             mappings without intermediate copies.
+*   Date    : October 28, 2024
+*
+****************************************************************************/
+
+#include "bwt_mmap.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace bwt {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : fd(std::exchange(other.fd, -1)),
+      addr(std::exchange(other.addr, nullptr)),
+      length(std::exchange(other.length, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd = std::exchange(other.fd, -1);
+        addr = std::exchange(other.addr, nullptr);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+bool MappedFile::openRead(const std::string& path) {
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length == 0) return true;
+
+    addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        addr = nullptr;
+        close();
+        return false;
+    }
+    // Blocks are consumed front to back.
+    ::madvise(addr, length, MADV_SEQUENTIAL);
+    return true;
+}
+
+bool MappedFile::create(const std::string& path, size_t size) {
+    close();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close();
+        return false;
+    }
+    length = size;
+    if (length == 0) return true;
+
+    addr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        addr = nullptr;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::close(size_t size) {
+    if (addr) ::munmap(addr, length);
+    addr = nullptr;
+    bool ok = fd >= 0 && ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+    close();
+    return ok;
+}
+
+void MappedFile::close() {
+    if (addr) ::munmap(addr, length);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    addr = nullptr;
+    length = 0;
+}
+
+int transformFile(BurrowsWheelerTransform& xform, const std::string& inPath,
+                  const std::string& outPath, XformMethod method) {
+    MappedFile in, out;
+    if (!in.openRead(inPath) || !out.create(outPath, xform.transformedSize(in.size()))) {
+        std::cerr << "Unable to map BWT input or output file." << std::endl;
+        return -1;
+    }
+
+    long written = xform.transform(in.data(), in.size(), out.data(), out.size(), method);
+    if (written < 0) return -1;
+    return out.close(static_cast<size_t>(written)) ? 0 : -1;
+}
+
+int reverseTransformFile(BurrowsWheelerTransform& xform, const std::string& inPath,
+                         const std::string& outPath, XformMethod method) {
+    MappedFile in, out;
+    if (!in.openRead(inPath)) {
+        std::cerr << "Unable to map BWT input file." << std::endl;
+        return -1;
+    }
+    long total = BurrowsWheelerTransform::originalSize(in.data(), in.size());
+    if (total < 0) {
+        std::cerr << "Invalid BWT stream header." << std::endl;
+        return -1;
+    }
+    if (!out.create(outPath, static_cast<size_t>(total))) {
+        std::cerr << "Unable to map BWT output file." << std::endl;
+        return -1;
+    }
+
+    long written = xform.reverseTransform(in.data(), in.size(), out.data(), out.size(), method);
+    if (written < 0) return -1;
+    return out.close(static_cast<size_t>(written)) ? 0 : -1;
+}
+
+} // namespace bwt
@@ -0,0 +1,48 @@
+#ifndef BWT_MMAP_HPP
+#define BWT_MMAP_HPP
+
+#include "bwt.hpp"
+#include <string>
+
+namespace bwt {
+
+// Read-only or read-write memory mapping of a whole file (POSIX mmap).
+// An empty file maps to a null pointer with size 0.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Maps an existing file read-only. Returns false on failure.
+    bool openRead(const std::string& path);
+    // Creates or truncates path to size bytes and maps it writable.
+    bool create(const std::string& path, size_t size);
+    // Shrinks a writable mapping's file to size bytes and unmaps it.
+    bool close(size_t size);
+    void close();
+
+    unsigned char* data() const { return static_cast<unsigned char*>(addr); }
+    size_t size() const { return length; }
+    bool isOpen() const { return fd >= 0; }
+
+private:
+    int fd = -1;
+    void* addr = nullptr;
+    size_t length = 0;
+};
+
+// File drivers that map input and output and run the in-memory transform
+// between the two mappings, so data moves straight between the page cache
+// and the transform without iostream buffering.
+int transformFile(BurrowsWheelerTransform& xform, const std::string& inPath,
+                  const std::string& outPath, XformMethod method);
+int reverseTransformFile(BurrowsWheelerTransform& xform, const std::string& inPath,
+                         const std::string& outPath, XformMethod method);
+
+} // namespace bwt
+
+#endif // BWT_MMAP_HPP
@@ -0,0 +1,234 @@
+/***************************************************************************
+*           Block-Parallel Driver for Burrows-Wheeler Transform Library
+*
+*   File    : bwt_parallel.cpp
+*   Purpose : Runs the per-block transform and its inverse on a pool of
+*             worker threads with an ordered writer and a bounded queue.
+*   Date    : October 28, 2024
+*
+****************************************************************************/
+
+#include "bwt_parallel.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+
+namespace bwt {
+
+namespace {
+
+struct Job {
+    std::vector<unsigned char> in;
+    std::vector<unsigned char> out;
+    size_t length = 0;
+    std::array<size_t, BurrowsWheelerTransform::MAX_DECODE_STREAMS> starts{};
+    bool ready = false;   // Processed and waiting for the writer
+    bool failed = false;
+};
+
+// Reads on the calling thread, processes on the worker threads and writes on
+// a dedicated thread. read(Job&) fills the next block and returns false at end
+// of input, work(Job&, worker) processes it and write(const Job&) emits it;
+// the latter two return false on failure. Block seq always lives in
+// jobs[seq % depth], which the reader only refills once seq has been written.
+template <class Read, class Work, class Write>
+int runPipeline(size_t workerCount, size_t depth, Read read, Work work, Write write) {
+    std::vector<Job> jobs(depth);
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<size_t> pending;
+    size_t readCount = 0;
+    size_t written = 0;
+    bool endOfInput = false;
+    bool failed = false;
+
+    auto worker = [&](size_t id) {
+        for (;;) {
+            size_t seq;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return failed || endOfInput || !pending.empty(); });
+                if (failed || pending.empty()) return;
+                seq = pending.front();
+                pending.pop_front();
+            }
+            Job& job = jobs[seq % depth];
+            bool ok = work(job, id);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                job.failed = !ok;
+                job.ready = true;
+            }
+            cv.notify_all();
+        }
+    };
+
+    auto writer = [&] {
+        for (;;) {
+            Job* job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] {
+                    return failed || jobs[written % depth].ready || (endOfInput && written == readCount);
+                });
+                job = &jobs[written % depth];
+                if (failed || !job->ready) return;
+                if (job->failed) {
+                    failed = true;
+                    cv.notify_all();
+                    return;
+                }
+            }
+            bool ok = write(*job);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                job->ready = false;
+                written++;
+                if (!ok) failed = true;
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workerCount + 1);
+    for (size_t id = 0; id < workerCount; ++id) {
+        threads.emplace_back(worker, id);
+    }
+    threads.emplace_back(writer);
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return failed || readCount < written + depth; });
+            if (failed) break;
+        }
+        if (!read(jobs[readCount % depth])) break;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(readCount);
+            readCount++;
+        }
+        cv.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        endOfInput = true;
+    }
+    cv.notify_all();
+
+    for (auto& t : threads) t.join();
+    return failed ? -1 : 0;
+}
+
+} // namespace
+
+ParallelBurrowsWheelerTransform::ParallelBurrowsWheelerTransform(size_t blockSize, size_t threads,
+                                                                 size_t queueDepth, size_t decodeStreams)
+    : blockSize(blockSize), queueDepth(queueDepth), decodeStreams(decodeStreams) {
+    if (threads == 0) threads = 1;
+    if (this->queueDepth == 0) this->queueDepth = 2 * threads;
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(blockSize, decodeStreams);
+    }
+}
+
+BwtStats ParallelBurrowsWheelerTransform::stats() const {
+    BwtStats total;
+    for (const BurrowsWheelerTransform& worker : workers) {
+        const BwtStats& s = worker.stats();
+        if (s.blocks > 0) {
+            total.minBlockBytesPerSecond = total.blocks == 0 ? s.minBlockBytesPerSecond
+                                                             : std::min(total.minBlockBytesPerSecond,
+                                                                        s.minBlockBytesPerSecond);
+            total.lastBlockBytesPerSecond = s.lastBlockBytesPerSecond;
+        }
+        total.maxBlockBytesPerSecond = std::max(total.maxBlockBytesPerSecond, s.maxBlockBytesPerSecond);
+        total.blocks += s.blocks;
+        total.bytes += s.bytes;
+        total.sortSeconds += s.sortSeconds;
+        total.mtfSeconds += s.mtfSeconds;
+        total.transformSeconds += s.transformSeconds;
+        total.reverseBlocks += s.reverseBlocks;
+        total.reverseBytes += s.reverseBytes;
+        total.reverseSeconds += s.reverseSeconds;
+    }
+    return total;
+}
+
+void ParallelBurrowsWheelerTransform::resetStats() {
+    for (BurrowsWheelerTransform& worker : workers) worker.resetStats();
+}
+
+int ParallelBurrowsWheelerTransform::transform(std::ifstream& fpIn, std::ofstream& fpOut, XformMethod method) {
+    if (!fpIn.is_open() || !fpOut.is_open()) {
+        std::cerr << "Invalid file stream provided." << std::endl;
+        return -1;
+    }
+
+    const size_t width = BurrowsWheelerTransform::indexWidth(blockSize);
+    BurrowsWheelerTransform::writeHeader(fpOut, blockSize, decodeStreams);
+
+    auto read = [&](Job& job) {
+        job.in.resize(blockSize);
+        fpIn.read(reinterpret_cast<char*>(job.in.data()), blockSize);
+        job.length = fpIn.gcount();
+        return job.length > 0;
+    };
+    auto work = [&](Job& job, size_t id) {
+        job.out.resize(blockSize);
+        workers[id].transformBlock(job.in.data(), job.length, job.out.data(), method,
+                                   job.starts.data(), decodeStreams);
+        return true;
+    };
+    auto write = [&](const Job& job) {
+        for (size_t k = 0; k < decodeStreams; ++k) {
+            BurrowsWheelerTransform::writeIndex(fpOut, job.starts[k], width);
+        }
+        fpOut.write(reinterpret_cast<const char*>(job.out.data()), job.length);
+        return fpOut.good();
+    };
+    return runPipeline(workers.size(), queueDepth, read, work, write);
+}
+
+int ParallelBurrowsWheelerTransform::reverseTransform(std::ifstream& fpIn, std::ofstream& fpOut,
+                                                      XformMethod method) {
+    if (!fpIn.is_open() || !fpOut.is_open()) {
+        std::cerr << "Invalid file stream provided." << std::endl;
+        return -1;
+    }
+
+    size_t streamBlockSize, streams;
+    if (!BurrowsWheelerTransform::readHeader(fpIn, streamBlockSize, streams)) return -1;
+    const size_t width = BurrowsWheelerTransform::indexWidth(streamBlockSize);
+
+    auto read = [&](Job& job) {
+        if (!BurrowsWheelerTransform::readIndex(fpIn, job.starts[0], width)) return false;
+        for (size_t k = 1; k < streams; ++k) {
+            // A truncated index list leaves length 0, which the worker rejects.
+            if (!BurrowsWheelerTransform::readIndex(fpIn, job.starts[k], width)) {
+                job.length = 0;
+                return true;
+            }
+        }
+        job.in.resize(streamBlockSize);
+        fpIn.read(reinterpret_cast<char*>(job.in.data()), streamBlockSize);
+        job.length = fpIn.gcount();
+        return true;
+    };
+    auto work = [&](Job& job, size_t id) {
+        job.out.resize(streamBlockSize);
+        return workers[id].reverseTransformBlock(job.in.data(), job.length, job.starts.data(), streams,
+                                                 job.out.data(), method) == 0;
+    };
+    auto write = [&](const Job& job) {
+        fpOut.write(reinterpret_cast<const char*>(job.out.data()), job.length);
+        return fpOut.good();
+    };
+    return runPipeline(workers.size(), queueDepth, read, work, write);
+}
+
+} // namespace bwt
@@ -0,0 +1,47 @@
+#ifndef BWT_PARALLEL_HPP
+#define BWT_PARALLEL_HPP
+
+#include "bwt.hpp"
+#include <thread>
+
+namespace bwt {
+
+// Block-parallel driver for BurrowsWheelerTransform. The calling thread reads
+// blocks, `threads` workers each run sort + MTF (or the inverse) on their own
+// block, and a writer thread emits the results in input order. At most
+// `queueDepth` blocks are in flight, bounding memory to roughly
+// queueDepth * 2 * blockSize plus each worker's scratch buffers.
+//
+// The stream format is the same as BurrowsWheelerTransform's, so either
+// class can decode the other's output.
+class ParallelBurrowsWheelerTransform {
+public:
+    // queueDepth of 0 selects twice the number of workers. Throws
+    // std::invalid_argument for an unsupported block size or stream count.
+    explicit ParallelBurrowsWheelerTransform(
+        size_t blockSize = BurrowsWheelerTransform::DEFAULT_BLOCK_SIZE,
+        size_t threads = std::thread::hardware_concurrency(),
+        size_t queueDepth = 0,
+        size_t decodeStreams = BurrowsWheelerTransform::DEFAULT_DECODE_STREAMS);
+
+    int transform(std::ifstream& fpIn, std::ofstream& fpOut, XformMethod method);
+    int reverseTransform(std::ifstream& fpIn, std::ofstream& fpOut, XformMethod method);
+
+    size_t getBlockSize() const { return blockSize; }
+    size_t getThreads() const { return workers.size(); }
+    // Timings summed over the workers; the per-block minimum, maximum and
+    // last throughputs are taken across all of them. Read it only between
+    // transforms.
+    BwtStats stats() const;
+    void resetStats();
+
+private:
+    size_t blockSize;
+    size_t queueDepth;
+    size_t decodeStreams;
+    std::vector<BurrowsWheelerTransform> workers;
+};
+
+} // namespace bwt
+
+#endif // BWT_PARALLEL_HPP
@@ -0,0 +1,218 @@
+/***************************************************************************
+*                        Implementation for FM-Index
+*
+*   File    : fm_index.cpp
+*   Purpose : Builds the BWT of a whole text with the suffix array engine and
+*             answers count/locate queries through backward search.
+*   Date    : October 28, 2024
+*
+****************************************************************************/
+
+#include "fm_index.hpp"
+#include "../Suffix Array/suffix_array.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace bwt {
+
+RankBitVector::RankBitVector(size_t n) : lines(n / BITS_PER_LINE + 1), n(n) {}
+
+void RankBitVector::build() {
+    uint64_t count = 0;
+    for (auto& line : lines) {
+        line.count = count;
+        for (uint64_t word : line.bits) {
+            count += __builtin_popcountll(word);
+        }
+    }
+}
+
+size_t RankBitVector::rank1(size_t i) const {
+    const Line& line = lines[i / BITS_PER_LINE];
+    size_t offset = i % BITS_PER_LINE;
+    size_t full = offset / 64;
+    size_t r = line.count;
+    for (size_t w = 0; w < full; ++w) {
+        r += __builtin_popcountll(line.bits[w]);
+    }
+    if (offset % 64 != 0) {
+        r += __builtin_popcountll(line.bits[full] & ((uint64_t(1) << (offset % 64)) - 1));
+    }
+    return r;
+}
+
+WaveletMatrix::WaveletMatrix(const unsigned char* data, size_t n) : n(n) {
+    std::vector<unsigned char> cur(data, data + n), next(n);
+    for (int level = 0; level < LEVELS; ++level) {
+        const int bit = LEVELS - 1 - level;
+        RankBitVector& bv = levels[level];
+        bv = RankBitVector(n);
+
+        size_t z = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if ((cur[i] >> bit) & 1) {
+                bv.set(i);
+            } else {
+                z++;
+            }
+        }
+        bv.build();
+        zeros[level] = z;
+
+        // Stable partition: zeros keep their order, ones follow.
+        size_t zi = 0, oi = z;
+        for (size_t i = 0; i < n; ++i) {
+            if ((cur[i] >> bit) & 1) {
+                next[oi++] = cur[i];
+            } else {
+                next[zi++] = cur[i];
+            }
+        }
+        cur.swap(next);
+    }
+
+    for (int c = 0; c < 256; ++c) {
+        size_t pos = 0;
+        for (int level = 0; level < LEVELS; ++level) {
+            bool b = (c >> (LEVELS - 1 - level)) & 1;
+            pos = b ? zeros[level] + levels[level].rank1(pos) : levels[level].rank0(pos);
+        }
+        start[c] = pos;
+    }
+}
+
+unsigned char WaveletMatrix::access(size_t i) const {
+    size_t unused;
+    return accessRank(i, unused);
+}
+
+size_t WaveletMatrix::rank(unsigned char c, size_t i) const {
+    for (int level = 0; level < LEVELS; ++level) {
+        bool b = (c >> (LEVELS - 1 - level)) & 1;
+        i = b ? zeros[level] + levels[level].rank1(i) : levels[level].rank0(i);
+    }
+    return i - start[c];
+}
+
+unsigned char WaveletMatrix::accessRank(size_t i, size_t& rankOut) const {
+    unsigned c = 0;
+    for (int level = 0; level < LEVELS; ++level) {
+        bool b = levels[level].get(i);
+        c = (c << 1) | b;
+        i = b ? zeros[level] + levels[level].rank1(i) : levels[level].rank0(i);
+    }
+    rankOut = i - start[c];
+    return static_cast<unsigned char>(c);
+}
+
+size_t WaveletMatrix::sizeInBytes() const {
+    size_t total = 0;
+    for (const auto& bv : levels) total += bv.sizeInBytes();
+    return total;
+}
+
+FMIndex::FMIndex(const std::string& text, size_t sampleRate)
+    : FMIndex(reinterpret_cast<const unsigned char*>(text.data()), text.size(), sampleRate) {}
+
+FMIndex::FMIndex(const unsigned char* text, size_t n, size_t sampleRate)
+    : sampleRate(sampleRate), n(n) {
+    if (sampleRate == 0) {
+        throw std::invalid_argument("FM-index sample rate must be positive");
+    }
+    if (n >= static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw std::length_error("FM-index text exceeds 2^31 - 1 bytes");
+    }
+
+    std::vector<unsigned int> sa(n);
+    sa::SuffixArray::build(text, n, sa.data());
+
+    // Row 0 is the suffix "$" alone; row r > 0 is suffix sa[r - 1]. The $ in
+    // the last column is stored as byte 0 and corrected for in rank().
+    std::vector<unsigned char> last(n + 1);
+    last[0] = n > 0 ? text[n - 1] : 0;
+    for (size_t r = 1; r <= n; ++r) {
+        size_t s = sa[r - 1];
+        if (s == 0) {
+            dollarRow = r;
+            last[r] = 0;
+        } else {
+            last[r] = text[s - 1];
+        }
+    }
+
+    std::array<size_t, 256> counts{};
+    for (size_t i = 0; i < n; ++i) counts[text[i]]++;
+    C[0] = 1;
+    for (int c = 0; c < 256; ++c) C[c + 1] = C[c] + counts[c];
+
+    bwt = WaveletMatrix(last.data(), last.size());
+
+    sampled = RankBitVector(n + 1);
+    if (n % sampleRate == 0) sampled.set(0);
+    for (size_t r = 1; r <= n; ++r) {
+        if (sa[r - 1] % sampleRate == 0) sampled.set(r);
+    }
+    sampled.build();
+
+    samples.reserve(sampled.rank1(n + 1));
+    if (n % sampleRate == 0) samples.push_back(static_cast<uint32_t>(n));
+    for (size_t r = 1; r <= n; ++r) {
+        if (sa[r - 1] % sampleRate == 0) samples.push_back(sa[r - 1]);
+    }
+}
+
+size_t FMIndex::rank(unsigned char c, size_t i) const {
+    size_t r = bwt.rank(c, i);
+    if (c == 0 && dollarRow < i) r--;
+    return r;
+}
+
+bool FMIndex::search(std::string_view pattern, size_t& sp, size_t& ep) const {
+    if (pattern.empty()) return false;
+    sp = 0;
+    ep = n + 1;
+    for (size_t k = pattern.size(); k-- > 0;) {
+        unsigned char c = static_cast<unsigned char>(pattern[k]);
+        sp = C[c] + rank(c, sp);
+        ep = C[c] + rank(c, ep);
+        if (sp >= ep) return false;
+    }
+    return true;
+}
+
+size_t FMIndex::count(std::string_view pattern) const {
+    size_t sp, ep;
+    return search(pattern, sp, ep) ? ep - sp : 0;
+}
+
+size_t FMIndex::locateRow(size_t row) const {
+    // The $ row always holds a sample (text position 0), so the walk ends.
+    size_t steps = 0;
+    while (!sampled.get(row)) {
+        size_t r;
+        unsigned char c = bwt.accessRank(row, r);
+        if (c == 0 && dollarRow < row) r--;
+        row = C[c] + r;
+        steps++;
+    }
+    return samples[sampled.rank1(row)] + steps;
+}
+
+std::vector<size_t> FMIndex::locate(std::string_view pattern) const {
+    std::vector<size_t> positions;
+    size_t sp, ep;
+    if (!search(pattern, sp, ep)) return positions;
+
+    positions.reserve(ep - sp);
+    for (size_t row = sp; row < ep; ++row) {
+        positions.push_back(locateRow(row));
+    }
+    return positions;
+}
+
+size_t FMIndex::sizeInBytes() const {
+    return bwt.sizeInBytes() + sampled.sizeInBytes() + samples.size() * sizeof(uint32_t) + sizeof(C);
+}
+
+} // namespace bwt
@@ -0,0 +1,110 @@
+#ifndef FM_INDEX_HPP
+#define FM_INDEX_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bwt {
+
+// Bit vector with constant time rank. Each 64-byte cache line holds the
+// number of ones before it followed by 448 bits, so rank1 touches exactly one
+// line.
+class RankBitVector {
+public:
+    RankBitVector() = default;
+    explicit RankBitVector(size_t n);
+
+    // Bits may only be set before build().
+    void set(size_t i) { lines[i / BITS_PER_LINE].bits[(i % BITS_PER_LINE) / 64] |= uint64_t(1) << (i % 64); }
+    void build();
+
+    bool get(size_t i) const {
+        return (lines[i / BITS_PER_LINE].bits[(i % BITS_PER_LINE) / 64] >> (i % 64)) & 1;
+    }
+    // Number of ones in [0, i).
+    size_t rank1(size_t i) const;
+    size_t rank0(size_t i) const { return i - rank1(i); }
+
+    size_t size() const { return n; }
+    size_t sizeInBytes() const { return lines.size() * sizeof(Line); }
+
+private:
+    static constexpr size_t WORDS_PER_LINE = 7;
+    static constexpr size_t BITS_PER_LINE = WORDS_PER_LINE * 64;
+
+    struct alignas(64) Line {
+        uint64_t count;
+        uint64_t bits[WORDS_PER_LINE];
+    };
+
+    std::vector<Line> lines;
+    size_t n = 0;
+};
+
+// Wavelet matrix over bytes: eight rank bit vectors, one per bit from the most
+// significant down. access and rank each cost one cache line per level.
+class WaveletMatrix {
+public:
+    WaveletMatrix() = default;
+    WaveletMatrix(const unsigned char* data, size_t n);
+
+    unsigned char access(size_t i) const;
+    // Occurrences of c in [0, i).
+    size_t rank(unsigned char c, size_t i) const;
+    // Returns data[i] and stores the occurrences of it in [0, i) in rankOut,
+    // in a single pass over the levels.
+    unsigned char accessRank(size_t i, size_t& rankOut) const;
+
+    size_t size() const { return n; }
+    size_t sizeInBytes() const;
+
+private:
+    static constexpr int LEVELS = 8;
+
+    std::array<RankBitVector, LEVELS> levels;
+    std::array<size_t, LEVELS> zeros{};
+    // Position of the first occurrence of each symbol after the last level.
+    std::array<size_t, 256> start{};
+    size_t n = 0;
+};
+
+// FM-index over a byte string: the BWT of text$ in a wavelet matrix plus a
+// suffix array sampled every sampleRate text positions. count() costs
+// O(|pattern|) rank queries; locate() adds at most sampleRate LF steps per
+// occurrence. The text is limited to 2^31 - 1 bytes.
+class FMIndex {
+public:
+    FMIndex() = default;
+    explicit FMIndex(const std::string& text, size_t sampleRate = 32);
+    FMIndex(const unsigned char* text, size_t n, size_t sampleRate = 32);
+
+    // Number of occurrences of pattern in the text. An empty pattern
+    // matches nothing.
+    size_t count(std::string_view pattern) const;
+    // Starting offsets of all occurrences of pattern, in no particular order.
+    std::vector<size_t> locate(std::string_view pattern) const;
+
+    size_t size() const { return n; }
+    size_t sizeInBytes() const;
+
+private:
+    // Backward search; fills the BWT row range [sp, ep) of pattern.
+    bool search(std::string_view pattern, size_t& sp, size_t& ep) const;
+    size_t rank(unsigned char c, size_t i) const;
+    size_t locateRow(size_t row) const;
+
+    WaveletMatrix bwt;
+    std::array<size_t, 257> C{};
+    RankBitVector sampled;
+    std::vector<uint32_t> samples;
+    size_t dollarRow = 0;
+    size_t sampleRate = 32;
+    size_t n = 0;
+};
+
+} // namespace bwt
+
+#endif // FM_INDEX_HPP
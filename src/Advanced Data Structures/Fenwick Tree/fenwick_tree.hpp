@@ -0,0 +1,168 @@
+#ifndef FENWICK_TREE_HPP
+#define FENWICK_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace fenwick {
+
+// Binary indexed tree over n values of an additive type T (anything with
+// +, - and a zero from T()): prefix sums and point updates in O(log n).
+// Node i (1-based) holds the sum of values (i - lowbit(i), i].
+//
+// Construction is O(n). With threads > 1 the array is cut into power of two
+// aligned chunks that are built independently, since a node inside a chunk
+// only covers values of that chunk; the chunk ends then form a Fenwick tree
+// over the chunk sums, which one thread finishes in O(n / chunk). This is
+// what makes building over 10^9 values bandwidth-bound rather than a single
+// core's pass.
+template<typename T>
+class FenwickTree {
+public:
+    FenwickTree() = default;
+    // n zero values
+    explicit FenwickTree(size_t n) : tree(new T[n + 1]()), length(n) {}
+    FenwickTree(const T* values, size_t n, size_t threads = 1) : tree(new T[n + 1]), length(n) {
+        build(values, threads);
+    }
+    explicit FenwickTree(const std::vector<T>& values, size_t threads = 1)
+        : FenwickTree(values.data(), values.size(), threads) {}
+
+    [[nodiscard]] size_t size() const { return length; }
+
+    // Adds delta to value i; throws std::out_of_range.
+    void add(size_t i, const T& delta) {
+        if (i >= length) throw std::out_of_range("FenwickTree::add: index out of range");
+        for (size_t k = i + 1; k <= length; k += lowbit(k)) {
+            tree[k] = tree[k] + delta;
+        }
+    }
+    void set(size_t i, const T& value) { add(i, value - get(i)); }
+
+    // Sum of the first count values; throws std::out_of_range if count > size().
+    [[nodiscard]] T prefixSum(size_t count) const {
+        if (count > length) throw std::out_of_range("FenwickTree::prefixSum: count out of range");
+        T sum = T();
+        for (size_t k = count; k > 0; k &= k - 1) {
+            sum = sum + tree[k];
+        }
+        return sum;
+    }
+    // Sum of values [begin, end)
+    [[nodiscard]] T rangeSum(size_t begin, size_t end) const {
+        if (begin > end) throw std::out_of_range("FenwickTree::rangeSum: begin after end");
+        return prefixSum(end) - prefixSum(begin);
+    }
+    // Value i, from the nodes below i + 1 rather than two full prefix sums
+    [[nodiscard]] T get(size_t i) const {
+        if (i >= length) throw std::out_of_range("FenwickTree::get: index out of range");
+        size_t k = i + 1;
+        T value = tree[k];
+        for (size_t stop = k - lowbit(k), j = k - 1; j > stop; j &= j - 1) {
+            value = value - tree[j];
+        }
+        return value;
+    }
+
+    // out[q] = prefixSum(counts[q]) for q < queries. Every node a prefix sum
+    // reads follows from count alone, so the last nodes of the queries
+    // AHEAD places on are prefetched while the current one is summed; the
+    // lower nodes are where the cache misses are, the upper ones stay hot.
+    void prefixSums(const size_t* counts, size_t queries, T* out) const {
+        for (size_t q = 0; q < queries; ++q) {
+            if (counts[q] > length) throw std::out_of_range("FenwickTree::prefixSums: count out of range");
+        }
+        for (size_t q = 0; q < queries; ++q) {
+            if (q + AHEAD < queries) {
+                size_t k = counts[q + AHEAD];
+                __builtin_prefetch(&tree[k]);
+                __builtin_prefetch(&tree[k & (k - 1)]);
+            }
+            T sum = T();
+            for (size_t k = counts[q]; k > 0; k &= k - 1) {
+                sum = sum + tree[k];
+            }
+            out[q] = sum;
+        }
+    }
+    [[nodiscard]] std::vector<T> prefixSums(const std::vector<size_t>& counts) const {
+        std::vector<T> out(counts.size());
+        prefixSums(counts.data(), counts.size(), out.data());
+        return out;
+    }
+
+    // Index of the value at which the running sum first reaches target, or
+    // size() if the total stays below it. Needs non-negative values; with
+    // counts this answers percentile queries.
+    [[nodiscard]] size_t lowerBound(const T& target) const {
+        size_t position = 0;
+        T remaining = target;
+        size_t step = 1;
+        while (step <= length / 2) step <<= 1;
+        for (; step > 0 && length > 0; step >>= 1) {
+            size_t next = position + step;
+            if (next <= length && tree[next] < remaining) {
+                position = next;
+                remaining = remaining - tree[next];
+            }
+        }
+        return position;
+    }
+
+private:
+    static constexpr size_t AHEAD = 8;
+    // Builds below this size are not worth a thread
+    static constexpr size_t MIN_CHUNK = size_t(1) << 16;
+
+    static size_t lowbit(size_t k) { return k & (~k + 1); }
+
+    // Fills tree[first..last] with values[first - 1..last - 1] and folds
+    // every node into its parent as long as the parent is at most last.
+    void buildChunk(const T* values, size_t first, size_t last) {
+        std::copy(values + first - 1, values + last, &tree[first]);
+        for (size_t k = first; k <= last; ++k) {
+            size_t parent = k + lowbit(k);
+            if (parent <= last) tree[parent] = tree[parent] + tree[k];
+        }
+    }
+
+    void build(const T* values, size_t threads) {
+        if (length == 0) return;
+        if (threads <= 1 || length < 2 * MIN_CHUNK) {
+            buildChunk(values, 1, length);
+            return;
+        }
+        // A few chunks per thread evens out the last, partial one
+        size_t chunk = MIN_CHUNK;
+        while (chunk * threads * 4 < length) chunk <<= 1;
+        size_t chunks = (length + chunk - 1) / chunk;
+        threads = std::min(threads, chunks);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([this, values, chunk, chunks, threads, t] {
+                for (size_t c = chunks * t / threads; c < chunks * (t + 1) / threads; ++c) {
+                    buildChunk(values, c * chunk + 1, std::min((c + 1) * chunk, length));
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        // Chunk ends hold their chunk's sum; lowbit of a multiple of chunk
+        // is at least chunk, so their parents are chunk ends as well.
+        for (size_t k = chunk; k <= length; k += chunk) {
+            size_t parent = k + lowbit(k);
+            if (parent <= length) tree[parent] = tree[parent] + tree[k];
+        }
+    }
+
+    std::unique_ptr<T[]> tree;  // 1-based; tree[0] is unused
+    size_t length = 0;
+};
+
+} // namespace fenwick
+
+#endif // FENWICK_TREE_HPP
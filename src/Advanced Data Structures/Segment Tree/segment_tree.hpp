@@ -0,0 +1,385 @@
+#ifndef SEGMENT_TREE_HPP
+#define SEGMENT_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace segtree {
+
+// A Monoid names value_type and provides
+//   static value_type identity();
+//   static value_type combine(const value_type& left, const value_type& right);
+//   static value_type repeat(const value_type& v, size_t count);  // v combined count times
+// combine must be associative but need not be commutative. repeat is only
+// used by the range updates below.
+template<typename T>
+struct Sum {
+    using value_type = T;
+    static T identity() { return T(); }
+    static T combine(const T& a, const T& b) { return a + b; }
+    static T repeat(const T& v, size_t count) { return v * static_cast<T>(count); }
+};
+
+template<typename T>
+struct Min {
+    using value_type = T;
+    static T identity() { return std::numeric_limits<T>::max(); }
+    static T combine(const T& a, const T& b) { return b < a ? b : a; }
+    static T repeat(const T& v, size_t) { return v; }
+};
+
+template<typename T>
+struct Max {
+    using value_type = T;
+    static T identity() { return std::numeric_limits<T>::lowest(); }
+    static T combine(const T& a, const T& b) { return a < b ? b : a; }
+    static T repeat(const T& v, size_t) { return v; }
+};
+
+// An Action is a range update for a Monoid. It names update_type and provides
+//   static update_type identity();
+//   static update_type compose(const update_type& newer, const update_type& older);
+//   static value_type apply(const update_type& u, const value_type& v, size_t count);
+// where v is the combination of count values and apply returns what it
+// becomes once u has been applied to each of them. apply(identity(), v, n)
+// must be v, and apply must distribute over combine.
+//
+// NoUpdate leaves out the lazy tags altogether.
+struct NoUpdate {};
+
+// Adds a constant to every value in the range
+template<class Monoid>
+struct Add {
+    using value_type = typename Monoid::value_type;
+    using update_type = value_type;
+    static update_type identity() { return update_type(); }
+    static update_type compose(const update_type& newer, const update_type& older) { return newer + older; }
+    static value_type apply(const update_type& u, const value_type& v, size_t count) {
+        return v + Monoid::repeat(u, count);
+    }
+};
+
+// Overwrites every value in the range
+template<class Monoid>
+struct Assign {
+    using value_type = typename Monoid::value_type;
+    using update_type = std::optional<value_type>;
+    static update_type identity() { return std::nullopt; }
+    static update_type compose(const update_type& newer, const update_type& older) { return newer ? newer : older; }
+    static value_type apply(const update_type& u, const value_type& v, size_t count) {
+        return u ? Monoid::repeat(*u, count) : v;
+    }
+};
+
+// Iterative bottom-up segment tree over n values of a Monoid, with range
+// updates through lazy tags when Action is not NoUpdate. Queries and
+// updates take half-open ranges [begin, end).
+//
+// The values are kept in leaf blocks of LeafBlock elements, padded with the
+// identity, and the tree is built over the block aggregates: a power of two
+// number of leaves in an implicit heap (Eytzinger) layout, node i having
+// children 2i and 2i + 1, so the upper levels share a few cache lines and
+// the tree is LeafBlock times smaller than one node per value. The ends of
+// a query that cut through a block are reduced straight from the values,
+// in a loop written for the compiler to vectorise, and a whole block is
+// reduced pairwise, which keeps the order of a non-commutative combine.
+//
+// Queries do not push tags down: climbing from the two end leaves, each
+// partial result picks up the tags of the nodes it passes under, so query()
+// is const. Updates push the tags along the two boundary paths first, since
+// an older tag above the updated nodes must not end up applied after the
+// newer one.
+//
+// value_type and update_type must be default constructible. With
+// threads > 1 the build splits the tree into one subtree per thread and
+// joins their roots on the calling thread.
+template<class Monoid, class Action = NoUpdate, size_t LeafBlock = 16>
+class SegmentTree {
+public:
+    using value_type = typename Monoid::value_type;
+
+private:
+    static constexpr bool LAZY = !std::is_same<Action, NoUpdate>::value;
+    static_assert(LeafBlock > 0 && (LeafBlock & (LeafBlock - 1)) == 0, "LeafBlock must be a power of two");
+
+    template<class A, bool = LAZY>
+    struct Tags {
+        using type = typename A::update_type;
+    };
+    template<class A>
+    struct Tags<A, false> {
+        struct type {};
+    };
+    using update_type = typename Tags<Action>::type;
+
+public:
+    SegmentTree() = default;
+    // n identity values
+    explicit SegmentTree(size_t n) : SegmentTree(std::vector<value_type>(n, Monoid::identity())) {}
+    SegmentTree(const value_type* values, size_t n, size_t threads = 1) { build(values, n, threads); }
+    explicit SegmentTree(const std::vector<value_type>& values, size_t threads = 1)
+        : SegmentTree(values.data(), values.size(), threads) {}
+
+    [[nodiscard]] size_t size() const { return length; }
+
+    // Combination of values [begin, end), the identity if empty; throws
+    // std::out_of_range.
+    [[nodiscard]] value_type query(size_t begin, size_t end) const {
+        check(begin, end, "SegmentTree::query: range out of bounds");
+        if (begin == end) return Monoid::identity();
+        Cut cut = cutAt(begin, end);
+        value_type left = Monoid::identity(), right = Monoid::identity();
+        size_t leftCount = 0, rightCount = 0;
+        if (cut.leftPartial) {
+            size_t stop = std::min(end, cut.first * LeafBlock);
+            left = pendingOnElements(cut.first - 1, reduce(&items[begin], stop - begin), stop - begin);
+            leftCount = stop - begin;
+        }
+        if (cut.rightPartial) {
+            size_t start = cut.last * LeafBlock;
+            right = pendingOnElements(cut.last, reduce(&items[start], end - start), end - start);
+            rightCount = end - start;
+        }
+        // Counts are only kept when LAZY, and the paths are meaningful only
+        // while their counts are not 0
+        size_t leftPath = leaves + cut.first - 1;
+        size_t rightPath = leaves + cut.last;
+        for (size_t l = leaves + cut.first, r = leaves + cut.last; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) {
+                if constexpr (LAZY) leftCount += span(l);
+                left = Monoid::combine(left, tree[l++]);
+            }
+            if (r & 1) {
+                --r;
+                if constexpr (LAZY) rightCount += span(r);
+                right = Monoid::combine(tree[r], right);
+            }
+            // Both sides move under the parents of their paths
+            leftPath >>= 1;
+            rightPath >>= 1;
+            if constexpr (LAZY) {
+                // The root has no parent to pass under
+                if (leftCount && leftPath) left = Action::apply(lazy[leftPath], left, leftCount);
+                if (rightCount && rightPath) right = Action::apply(lazy[rightPath], right, rightCount);
+            }
+        }
+        if constexpr (LAZY) {
+            for (leftPath >>= 1; leftCount && leftPath > 0; leftPath >>= 1) {
+                left = Action::apply(lazy[leftPath], left, leftCount);
+            }
+            for (rightPath >>= 1; rightCount && rightPath > 0; rightPath >>= 1) {
+                right = Action::apply(lazy[rightPath], right, rightCount);
+            }
+        }
+        return Monoid::combine(left, right);
+    }
+    [[nodiscard]] value_type get(size_t i) const {
+        if (i >= length) throw std::out_of_range("SegmentTree::get: index out of range");
+        return query(i, i + 1);
+    }
+    // Combination of all values
+    [[nodiscard]] value_type total() const { return length ? tree[1] : Monoid::identity(); }
+
+    // Overwrites value i; throws std::out_of_range.
+    void set(size_t i, const value_type& value) {
+        if (i >= length) throw std::out_of_range("SegmentTree::set: index out of range");
+        size_t block = i / LeafBlock;
+        push(block);
+        items[i] = value;
+        pullBlock(block);
+        pull(block);
+    }
+
+    // Applies u to every value in [begin, end); throws std::out_of_range.
+    template<class A = Action, class = typename std::enable_if<!std::is_same<A, NoUpdate>::value>::type>
+    void update(size_t begin, size_t end, const typename A::update_type& u) {
+        check(begin, end, "SegmentTree::update: range out of bounds");
+        if (begin == end) return;
+        Cut cut = cutAt(begin, end);
+        bool hasLeft = cut.first > 0, hasRight = cut.last < leaves;
+        if (hasLeft) push(cut.first - 1);
+        if (hasRight) push(cut.last);
+        if (cut.leftPartial) {
+            size_t stop = std::min(end, cut.first * LeafBlock);
+            for (size_t i = begin; i < stop; ++i) items[i] = Action::apply(u, items[i], 1);
+            pullBlock(cut.first - 1);
+        }
+        if (cut.rightPartial) {
+            for (size_t i = cut.last * LeafBlock; i < end; ++i) items[i] = Action::apply(u, items[i], 1);
+            pullBlock(cut.last);
+        }
+        for (size_t l = leaves + cut.first, r = leaves + cut.last; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) applyTo(l++, u);
+            if (r & 1) applyTo(--r, u);
+        }
+        if (hasLeft) pull(cut.first - 1);
+        if (hasRight) pull(cut.last);
+    }
+
+private:
+    // A range splits into an optional partial block on each end and the
+    // whole blocks [first, last) between them. A range inside one block is
+    // reported as a left partial block with nothing after it.
+    struct Cut {
+        size_t first, last;
+        bool leftPartial, rightPartial;
+    };
+    Cut cutAt(size_t begin, size_t end) const {
+        size_t lo = begin / LeafBlock, hi = (end - 1) / LeafBlock;
+        // The tail block only holds length % LeafBlock values, so ending at
+        // length covers it whole.
+        bool leftPartial = begin % LeafBlock != 0;
+        bool rightPartial = end % LeafBlock != 0 && end != length;
+        if (lo == hi && (leftPartial || rightPartial)) return {lo + 1, lo + 1, true, false};
+        return {leftPartial ? lo + 1 : lo, rightPartial ? hi : hi + 1, leftPartial, rightPartial};
+    }
+
+    void check(size_t begin, size_t end, const char* what) const {
+        if (begin > end || end > length) throw std::out_of_range(what);
+    }
+
+    // Number of values under node i
+    size_t span(size_t i) const {
+        size_t above = height - (63 - __builtin_clzll(i));  // Levels between i and the leaves
+        size_t first = ((i << above) - leaves) * LeafBlock;
+        size_t last = first + (LeafBlock << above);
+        return std::min(last, length) - std::min(first, length);
+    }
+
+    // Combination of count consecutive values
+    static value_type reduce(const value_type* values, size_t count) {
+        if (count == LeafBlock) {
+            value_type pairs[LeafBlock];
+            std::copy(values, values + LeafBlock, pairs);
+            for (size_t width = LeafBlock / 2; width > 0; width /= 2) {
+                for (size_t k = 0; k < width; ++k) {
+                    pairs[k] = Monoid::combine(pairs[2 * k], pairs[2 * k + 1]);
+                }
+            }
+            return pairs[0];
+        }
+        value_type result = Monoid::identity();
+        for (size_t k = 0; k < count; ++k) {
+            result = Monoid::combine(result, values[k]);
+        }
+        return result;
+    }
+
+    // Values of block b seen through the tag its leaf still owes them
+    value_type pendingOnElements(size_t block, const value_type& v, size_t count) const {
+        if constexpr (LAZY) return Action::apply(lazy[leaves + block], v, count);
+        return v;
+    }
+
+    void applyTo(size_t i, const update_type& u) {
+        size_t count = span(i);
+        if (count == 0) return;  // Past the end; never read
+        tree[i] = Action::apply(u, tree[i], count);
+        lazy[i] = Action::compose(u, lazy[i]);
+    }
+
+    // Moves the tags above leaf block b down to it and on into its values.
+    void push(size_t block) {
+        if constexpr (LAZY) {
+            size_t leaf = leaves + block;
+            for (size_t shift = height; shift > 0; --shift) {
+                size_t i = leaf >> shift;
+                applyTo(2 * i, lazy[i]);
+                applyTo(2 * i + 1, lazy[i]);
+                lazy[i] = Action::identity();
+            }
+            size_t first = block * LeafBlock, last = std::min(first + LeafBlock, length);
+            for (size_t k = first; k < last; ++k) items[k] = Action::apply(lazy[leaf], items[k], 1);
+            lazy[leaf] = Action::identity();
+        }
+    }
+
+    void pullBlock(size_t block) { tree[leaves + block] = reduce(&items[block * LeafBlock], LeafBlock); }
+
+    // Recomputes the ancestors of leaf block b
+    void pull(size_t block) {
+        for (size_t i = (leaves + block) >> 1; i > 0; i >>= 1) {
+            tree[i] = Monoid::combine(tree[2 * i], tree[2 * i + 1]);
+            if constexpr (LAZY) {
+                if (size_t count = span(i)) tree[i] = Action::apply(lazy[i], tree[i], count);
+            }
+        }
+    }
+
+    // Combines nodes [first, last) of one level into their parents.
+    void buildLevel(size_t first, size_t last) {
+        for (size_t i = first / 2; i < last / 2; ++i) {
+            tree[i] = Monoid::combine(tree[2 * i], tree[2 * i + 1]);
+        }
+    }
+
+    // Copies and reduces blocks [first, last) and builds their subtree.
+    void buildBlocks(const value_type* values, size_t first, size_t last) {
+        size_t start = std::min(first * LeafBlock, length), stop = std::min(last * LeafBlock, length);
+        std::copy(values + start, values + stop, &items[start]);
+        // Padding starts inside at most one subtree; the others leave it alone
+        std::fill(&items[0] + std::max(stop, first * LeafBlock), &items[0] + last * LeafBlock, Monoid::identity());
+        for (size_t b = first; b < last; ++b) pullBlock(b);
+        if constexpr (LAZY) {
+            std::fill(&lazy[0] + leaves + first, &lazy[0] + leaves + last, Action::identity());
+        }
+        for (size_t lo = leaves + first, hi = leaves + last; hi - lo > 1; lo /= 2, hi /= 2) {
+            buildLevel(lo, hi);
+            if constexpr (LAZY) std::fill(&lazy[0] + lo / 2, &lazy[0] + hi / 2, Action::identity());
+        }
+    }
+
+    void build(const value_type* values, size_t n, size_t threads) {
+        length = n;
+        if (n == 0) return;
+        size_t blocks = (n + LeafBlock - 1) / LeafBlock;
+        leaves = 1;
+        height = 0;
+        while (leaves < blocks) {
+            leaves <<= 1;
+            height++;
+        }
+        items.reset(new value_type[leaves * LeafBlock]);
+        tree.reset(new value_type[2 * leaves]);
+        if constexpr (LAZY) lazy.reset(new update_type[2 * leaves]);
+
+        // One subtree per thread, a power of two of them
+        size_t subtrees = 1;
+        while (subtrees * 2 <= std::min(threads, leaves)) subtrees <<= 1;
+        size_t perSubtree = leaves / subtrees;
+        if (subtrees == 1) {
+            buildBlocks(values, 0, leaves);
+        } else {
+            std::vector<std::thread> workers;
+            workers.reserve(subtrees);
+            for (size_t s = 0; s < subtrees; ++s) {
+                workers.emplace_back([this, values, s, perSubtree] {
+                    buildBlocks(values, s * perSubtree, (s + 1) * perSubtree);
+                });
+            }
+            for (auto& worker : workers) worker.join();
+            for (size_t lo = subtrees, hi = 2 * subtrees; hi - lo > 1; lo /= 2, hi /= 2) {
+                buildLevel(lo, hi);
+                if constexpr (LAZY) std::fill(&lazy[0] + lo / 2, &lazy[0] + hi / 2, Action::identity());
+            }
+        }
+    }
+
+    std::unique_ptr<value_type[]> items;  // Leaf blocks, identity past the end
+    std::unique_ptr<value_type[]> tree;   // Node 1 is the root; leaves start at `leaves`
+    std::unique_ptr<update_type[]> lazy;  // What each node still owes its children; LAZY only
+    size_t length = 0;
+    size_t leaves = 0;
+    size_t height = 0;
+};
+
+} // namespace segtree
+
+#endif // SEGMENT_TREE_HPP
@@ -0,0 +1,220 @@
+/***************************************************************************
+*                   Implementation for Suffix Array Library
+*
+*   File    : suffix_array.cpp
+*   Purpose : Linear time suffix array construction (SA-IS) and sorting of
+*             cyclic rotations for the Burrows-Wheeler transform.
+*   Date    : October 28, 2024
+*
+****************************************************************************/
+
+#include "suffix_array.hpp"
+#include <algorithm>
+#include <numeric>  // For std::iota
+#include <stdexcept>
+#include <limits>
+
+namespace sa {
+
+namespace {
+
+constexpr int NAIVE_THRESHOLD = 10;
+
+// Comparison sort for tiny inputs, where SA-IS bucket setup costs more than
+// it saves.
+template <class Str>
+void saNaive(const Str& s, int n, int* sa) {
+    std::iota(sa, sa + n, 0);
+    std::sort(sa, sa + n, [&](int l, int r) {
+        if (l == r) return false;
+        while (l < n && r < n) {
+            if (s[l] != s[r]) return s[l] < s[r];
+            l++;
+            r++;
+        }
+        return l == n;
+    });
+}
+
+// SA-IS: classify suffixes as L/S type, induce-sort the LMS substrings,
+// name them and recurse on the reduced string when names are not unique.
+// s[i] must lie in [0, upper].
+template <class Str>
+void saIs(const Str& s, int n, int upper, int* sa) {
+    if (n < NAIVE_THRESHOLD) {
+        saNaive(s, n, sa);
+        return;
+    }
+
+    std::vector<bool> ls(n);
+    for (int i = n - 2; i >= 0; --i) {
+        ls[i] = (s[i] == s[i + 1]) ? ls[i + 1] : (s[i] < s[i + 1]);
+    }
+
+    // Bucket heads: sumL[c] is where L-type suffixes starting with c begin,
+    // sumS[c] where S-type ones do.
+    std::vector<int> sumL(upper + 1), sumS(upper + 1);
+    for (int i = 0; i < n; ++i) {
+        if (!ls[i]) {
+            sumS[s[i]]++;
+        } else {
+            sumL[s[i] + 1]++;
+        }
+    }
+    for (int i = 0; i <= upper; ++i) {
+        sumS[i] += sumL[i];
+        if (i < upper) sumL[i + 1] += sumS[i];
+    }
+
+    std::vector<int> buf(upper + 1);
+    auto induce = [&](const std::vector<int>& lms) {
+        std::fill(sa, sa + n, -1);
+        std::copy(sumS.begin(), sumS.end(), buf.begin());
+        for (int d : lms) {
+            if (d == n) continue;
+            sa[buf[s[d]]++] = d;
+        }
+        std::copy(sumL.begin(), sumL.end(), buf.begin());
+        sa[buf[s[n - 1]]++] = n - 1;
+        for (int i = 0; i < n; ++i) {
+            int v = sa[i];
+            if (v >= 1 && !ls[v - 1]) {
+                sa[buf[s[v - 1]]++] = v - 1;
+            }
+        }
+        std::copy(sumL.begin(), sumL.end(), buf.begin());
+        for (int i = n - 1; i >= 0; --i) {
+            int v = sa[i];
+            if (v >= 1 && ls[v - 1]) {
+                sa[--buf[s[v - 1] + 1]] = v - 1;
+            }
+        }
+    };
+
+    std::vector<int> lmsMap(n + 1, -1);
+    std::vector<int> lms;
+    for (int i = 1; i < n; ++i) {
+        if (!ls[i - 1] && ls[i]) {
+            lmsMap[i] = static_cast<int>(lms.size());
+            lms.push_back(i);
+        }
+    }
+    int m = static_cast<int>(lms.size());
+
+    induce(lms);
+    if (m == 0) return;
+
+    std::vector<int> sortedLms;
+    sortedLms.reserve(m);
+    for (int i = 0; i < n; ++i) {
+        if (lmsMap[sa[i]] != -1) sortedLms.push_back(sa[i]);
+    }
+
+    // Name each LMS substring; equal substrings share a name.
+    std::vector<int> recS(m);
+    int recUpper = 0;
+    recS[lmsMap[sortedLms[0]]] = 0;
+    for (int i = 1; i < m; ++i) {
+        int l = sortedLms[i - 1], r = sortedLms[i];
+        int endL = (lmsMap[l] + 1 < m) ? lms[lmsMap[l] + 1] : n;
+        int endR = (lmsMap[r] + 1 < m) ? lms[lmsMap[r] + 1] : n;
+        bool same = true;
+        if (endL - l != endR - r) {
+            same = false;
+        } else {
+            while (l < endL && s[l] == s[r]) {
+                l++;
+                r++;
+            }
+            if (l == n || s[l] != s[r]) same = false;
+        }
+        if (!same) recUpper++;
+        recS[lmsMap[sortedLms[i]]] = recUpper;
+    }
+
+    std::vector<int> recSa(m);
+    saIs(recS, m, recUpper, recSa.data());
+
+    for (int i = 0; i < m; ++i) {
+        sortedLms[i] = lms[recSa[i]];
+    }
+    induce(sortedLms);
+}
+
+// Starting offset of the lexicographically least rotation (Duval).
+size_t leastRotation(const unsigned char* text, size_t n) {
+    size_t i = 0, ans = 0;
+    while (i < n) {
+        ans = i;
+        size_t j = i + 1, k = i;
+        while (j < 2 * n && text[k % n] <= text[j % n]) {
+            if (text[k % n] < text[j % n]) {
+                k = i;
+            } else {
+                k++;
+            }
+            j++;
+        }
+        while (i <= k) i += j - k;
+    }
+    return ans;
+}
+
+void checkLength(size_t n) {
+    if (n > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw std::length_error("suffix array input exceeds 2^31 - 1 bytes");
+    }
+}
+
+} // namespace
+
+SuffixArray::SuffixArray(const std::string& text)
+    : SuffixArray(reinterpret_cast<const unsigned char*>(text.data()), text.size()) {}
+
+SuffixArray::SuffixArray(const unsigned char* text, size_t n) : sa(n) {
+    build(text, n, sa.data());
+}
+
+void SuffixArray::build(const unsigned char* text, size_t n, unsigned int* out) {
+    checkLength(n);
+    if (n == 0) return;
+    saIs(text, static_cast<int>(n), 255, reinterpret_cast<int*>(out));
+}
+
+void SuffixArray::sortRotations(const unsigned char* text, size_t n, unsigned int* out) {
+    checkLength(n);
+    if (n == 0) return;
+
+    // Rotated to its least rotation the text is u^k for a Lyndon word u, and
+    // suffix order of a Lyndon word equals its rotation order. Sorting the
+    // suffixes of u therefore sorts every rotation class of the block.
+    size_t r = leastRotation(text, n);
+    std::vector<unsigned char> rotated(n);
+    std::copy(text + r, text + n, rotated.begin());
+    std::copy(text, text + r, rotated.begin() + (n - r));
+
+    size_t j = 1, k = 0;
+    while (j < n && rotated[k] <= rotated[j]) {
+        if (rotated[k] < rotated[j]) {
+            k = 0;
+        } else {
+            k++;
+        }
+        j++;
+    }
+    size_t period = j - k;
+    if (n % period != 0) period = n;
+
+    saIs(rotated.data(), static_cast<int>(period), 255, reinterpret_cast<int*>(out));
+
+    // Expand in place from the back so unread entries are never overwritten.
+    size_t copies = n / period;
+    for (size_t t = period; t-- > 0;) {
+        size_t s = out[t] + r;
+        for (size_t c = copies; c-- > 0;) {
+            out[t * copies + c] = static_cast<unsigned int>((s + c * period) % n);
+        }
+    }
+}
+
+} // namespace sa
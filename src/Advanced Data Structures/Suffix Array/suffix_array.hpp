@@ -0,0 +1,37 @@
+#ifndef SUFFIX_ARRAY_HPP
+#define SUFFIX_ARRAY_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sa {
+
+// Suffix array built with SA-IS (Nong, Zhang & Chan), linear time in the
+// length of the text regardless of how repetitive it is.
+class SuffixArray {
+public:
+    SuffixArray() = default;
+    explicit SuffixArray(const std::string& text);
+    SuffixArray(const unsigned char* text, size_t n);
+
+    size_t size() const { return sa.size(); }
+    unsigned int operator[](size_t i) const { return sa[i]; }
+    const unsigned int* data() const { return sa.data(); }
+
+    // Writes the suffix array of text[0..n) to out[0..n). Suffixes are
+    // ordered lexicographically with a proper prefix sorting first.
+    static void build(const unsigned char* text, size_t n, unsigned int* out);
+
+    // Writes the start offsets of the n cyclic rotations of text[0..n) to
+    // out[0..n) in sorted order, as needed by the Burrows-Wheeler transform.
+    // Equal rotations (periodic text) may appear in any order.
+    static void sortRotations(const unsigned char* text, size_t n, unsigned int* out);
+
+private:
+    std::vector<unsigned int> sa;
+};
+
+} // namespace sa
+
+#endif // SUFFIX_ARRAY_HPP
@@ -1,114 +1,266 @@
 #include "kinetic_hanger.hpp"
 
+#include <stdexcept>
+
 namespace kinetic {
 
-KineticHanger::KineticHanger() : root(nullptr), gen(rd()) {}
+template<class Stats>
+BasicKineticHanger<Stats>::BasicKineticHanger() : gen(rd()) {}
 
-void KineticHanger::buildHanger(const std::vector<int>& elements) {
-    root.reset();
-    while (!eventQueue.empty()) eventQueue.pop();
+template<class Stats>
+void BasicKineticHanger<Stats>::buildHanger(const std::vector<int>& elements) {
+    nodes.clear();
+    root = NIL;
+    eventQueue.clear();
+    index.clear();
+    nodes.reserve(elements.size());
+    index.reserve(elements.size());
 
-    // Sort elements by their priorities
-    std::vector<std::pair<int, int>> sortedElements;
+    // Any order works as the in-order sequence of a hanger, so the input
+    // order is kept and one stack pass links the heap
+    std::vector<Handle> order;
+    order.reserve(elements.size());
     for (int elem : elements) {
-        sortedElements.emplace_back(elem, getRandomPriority());
+        order.push_back(allocateNode(elem, getRandomPriority()));
     }
-    std::sort(sortedElements.begin(), sortedElements.end(),
-              [](const auto &a, const auto &b) { return a.second > b.second; });
+    root = nodes.linkCartesian(order, currentTime);
+    auto entries = nodes.certificates(root, currentTime);
+    counters.update([&](KineticStats& s) { s.certificatesPushed += entries.size(); });
+    eventQueue.build(std::move(entries));
+}
 
-    for (const auto &elem : sortedElements) {
-        root = hang(std::move(root), elem.first, elem.second);
-    }
+template<class Stats>
+void BasicKineticHanger<Stats>::insert(int element) {
+    hang(element, getRandomPriority());
+}
 
-    // Update the event queue
-    updateCertificates(root);
+template<class Stats>
+void BasicKineticHanger<Stats>::insert(int element, const Trajectory& priority) {
+    hang(element, priority);
 }
 
-void KineticHanger::insert(int element) {
-    int priority = getRandomPriority();
-    root = hang(std::move(root), element, priority);
-    updateCertificates(root);
+template<class Stats>
+void BasicKineticHanger<Stats>::remove(int element) {
+    deleteNode(element);
 }
 
-void KineticHanger::remove(int element) {
-    root = deleteNode(std::move(root), element);
-    updateCertificates(root);
+template<class Stats>
+void BasicKineticHanger<Stats>::insertBatch(const std::vector<int>& elements) {
+    std::vector<Trajectory> priorities;
+    priorities.reserve(elements.size());
+    for (size_t i = 0; i < elements.size(); ++i) {
+        priorities.push_back(getRandomPriority());
+    }
+    insertBatch(elements, priorities);
 }
 
-bool KineticHanger::isEmpty() const {
-    return root == nullptr;
+template<class Stats>
+void BasicKineticHanger<Stats>::insertBatch(const std::vector<int>& elements, const std::vector<Trajectory>& priorities) {
+    if (elements.size() != priorities.size()) {
+        throw std::invalid_argument("KineticHanger::insertBatch: one priority per element required");
+    }
+    std::vector<Handle> touched;
+    touched.reserve(elements.size());
+    for (size_t i = 0; i < elements.size(); ++i) {
+        touched.push_back(allocateNode(elements[i], priorities[i]));
+    }
+    Handle batch = nodes.linkCartesian(touched, currentTime);
+    root = meld(root, batch, touched);
+    if (root == NIL) return;  // Empty batch into an empty hanger
+    nodes.parent(root) = NIL;
+    for (Handle h : touched) certify(h);
+    certify(root);
 }
 
-std::unique_ptr<Node> KineticHanger::hang(std::unique_ptr<Node> node, int element, int priority) {
-    if (!node) return std::make_unique<Node>(element, priority);
+template<class Stats>
+void BasicKineticHanger<Stats>::removeBatch(const std::vector<int>& elements) {
+    for (int element : elements) {
+        deleteNode(element);
+    }
+}
 
-    if (priority > node->priority) {
-        auto newRoot = std::make_unique<Node>(element, priority);
-        newRoot->left = std::move(node);
-        return newRoot;
+template<class Stats>
+Handle BasicKineticHanger<Stats>::meld(Handle a, Handle b, std::vector<Handle>& touched) {
+    // Iterative: walk down from the higher root, each step keeping the
+    // higher of the two roots in place and continuing into a random child
+    if (a == NIL) return b;
+    if (b == NIL) return a;
+    if (priorityNow(b) > priorityNow(a)) std::swap(a, b);
+    Handle top = a;
+    for (;;) {
+        bool goLeft = gen() % 2 == 0;
+        Handle& slot = goLeft ? nodes.left(a) : nodes.right(a);
+        Handle child = slot;
+        if (child == NIL || priorityNow(b) > priorityNow(child)) {
+            // b takes the slot and carries on merging with what was there
+            slot = b;
+            nodes.parent(b) = a;
+            touched.push_back(b);
+            if (child == NIL) return top;
+            a = b;
+            b = child;
+        } else {
+            a = child;
+        }
     }
+}
 
-    // Randomly decide to place the element in the left or right subtree
-    if (gen() % 2 == 0) {
-        node->left = hang(std::move(node->left), element, priority);
-    } else {
-        node->right = hang(std::move(node->right), element, priority);
+template<class Stats>
+void BasicKineticHanger<Stats>::advance(double t) {
+    if (t < currentTime) {
+        throw std::invalid_argument("KineticHanger::advance: time must not go backwards");
     }
-    return node;
+    processEvents(eventQueue, currentTime, t, [this](Handle node) { handleCertificateFailure(node); });
 }
 
-std::unique_ptr<Node> KineticHanger::deleteNode(std::unique_ptr<Node> node, int element) {
-    if (!node) return nullptr;
+template<class Stats>
+bool BasicKineticHanger<Stats>::isEmpty() const {
+    return root == NIL;
+}
 
-    if (node->element == element) {
-        if (!node->left) return std::move(node->right);
-        if (!node->right) return std::move(node->left);
+template<class Stats>
+Handle BasicKineticHanger<Stats>::allocateNode(int element, const Trajectory& priority) {
+    Handle node = nodes.allocate(element, priority);
+    index.emplace(element, node);
+    return node;
+}
 
-        if (node->left->priority > node->right->priority) {
-            node->element = node->left->element;
-            node->priority = node->left->priority;
-            node->left = deleteNode(std::move(node->left), node->element);
-        } else {
-            node->element = node->right->element;
-            node->priority = node->right->priority;
-            node->right = deleteNode(std::move(node->right), node->element);
+template<class Stats>
+void BasicKineticHanger<Stats>::moveIndex(int element, Handle from, Handle to) {
+    auto range = index.equal_range(element);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == from) {
+            it->second = to;
+            return;
         }
-    } else if (gen() % 2 == 0) {
-        node->left = deleteNode(std::move(node->left), element);
+    }
+}
+
+template<class Stats>
+void BasicKineticHanger<Stats>::hang(int element, const Trajectory& priority) {
+    // Walk down randomly past every node that outranks the element, then
+    // take that position and hang the displaced subtree on the left
+    Handle parent = NIL;
+    Handle displaced = root;
+    bool goLeft = false;
+    double value = priority.at(currentTime);
+    while (displaced != NIL && value <= priorityNow(displaced)) {
+        parent = displaced;
+        goLeft = gen() % 2 == 0;
+        displaced = goLeft ? nodes.left(parent) : nodes.right(parent);
+    }
+    Handle node = allocateNode(element, priority);
+    if (parent == NIL) {
+        root = node;
+    } else if (goLeft) {
+        nodes.left(parent) = node;
     } else {
-        node->right = deleteNode(std::move(node->right), element);
+        nodes.right(parent) = node;
     }
-    return node;
+    nodes.parent(node) = parent;
+    nodes.left(node) = displaced;
+    if (displaced != NIL) nodes.parent(displaced) = node;
+
+    // Only the edges above and below the new node are new
+    certify(node);
+    if (displaced != NIL) certify(displaced);
 }
 
-void KineticHanger::updateCertificates(std::unique_ptr<Node>& node) {
-    if (!node) return;
+template<class Stats>
+void BasicKineticHanger<Stats>::deleteNode(int element) {
+    auto found = index.find(element);
+    if (found == index.end()) return;
+    Handle node = found->second;
+    index.erase(found);
 
-    // Clear the event queue and create new certificates for the current tree
-    while (!eventQueue.empty()) eventQueue.pop();
+    // Pull the higher-priority child's element up until the node to drop
+    // has at most one child; every node on the way changes contents
+    std::vector<Handle> changed;
+    while (nodes.left(node) != NIL && nodes.right(node) != NIL) {
+        Handle left = nodes.left(node);
+        Handle right = nodes.right(node);
+        Handle next = priorityNow(left) > priorityNow(right) ? left : right;
+        moveIndex(nodes.key(next), next, node);
+        counters.update([](KineticStats& s) { ++s.rotations; });
+        nodes.key(node) = nodes.key(next);
+        nodes.priority(node) = nodes.priority(next);
+        changed.push_back(node);
+        node = next;
+    }
+    Handle child = nodes.left(node) != NIL ? nodes.left(node) : nodes.right(node);
+    Handle parent = nodes.parent(node);
+    if (child != NIL) nodes.parent(child) = parent;
+    if (parent == NIL) {
+        root = child;
+    } else if (nodes.left(parent) == node) {
+        nodes.left(parent) = child;
+    } else {
+        nodes.right(parent) = child;
+    }
+    dropCertificate(node);
+    nodes.release(node);
 
-    // Traverse the tree and create certificates based on the priorities
-    std::queue<Node*> queue;
-    queue.push(node.get());
+    if (child != NIL) certify(child);
+    for (Handle h : changed) {
+        certify(h);
+        certifyChildren(h);
+    }
+}
 
-    while (!queue.empty()) {
-        Node* current = queue.front();
-        queue.pop();
+template<class Stats>
+void BasicKineticHanger<Stats>::handleCertificateFailure(Handle node) {
+    counters.update([](KineticStats& s) { ++s.events; });
+    Handle parent = nodes.parent(node);
+    if (parent == NIL) {
+        dropCertificate(node);
+        return;
+    }
 
-        if (current->left) {
-            eventQueue.push({current->element, current->priority});
-            queue.push(current->left.get());
-        }
-        if (current->right) {
-            eventQueue.push({current->element, current->priority});
-            queue.push(current->right.get());
-        }
+    // Swap the elements; the shape stays, so only the edges touching the
+    // two positions change
+    if (nodes.key(node) != nodes.key(parent)) {
+        moveIndex(nodes.key(node), node, parent);
+        moveIndex(nodes.key(parent), parent, node);
     }
+    counters.update([](KineticStats& s) { ++s.rotations; });
+    std::swap(nodes.key(node), nodes.key(parent));
+    std::swap(nodes.priority(node), nodes.priority(parent));
+    certify(parent);
+    certifyChildren(parent);
+    certifyChildren(node);
+}
+
+template<class Stats>
+void BasicKineticHanger<Stats>::certify(Handle node) {
+    Handle parent = nodes.parent(node);
+    if (parent == NIL) {
+        // The root has no parent edge to guard
+        dropCertificate(node);
+        return;
+    }
+    counters.update([](KineticStats& s) { ++s.certificatesPushed; });
+    eventQueue.push(node, {nodes.key(node), failureTime(nodes.priority(parent), nodes.priority(node), currentTime)});
+}
+
+template<class Stats>
+void BasicKineticHanger<Stats>::dropCertificate(Handle node) {
+    counters.update([&](KineticStats& s) { s.certificatesInvalidated += eventQueue.contains(node); });
+    eventQueue.erase(node);
+}
+
+template<class Stats>
+void BasicKineticHanger<Stats>::certifyChildren(Handle node) {
+    if (nodes.left(node) != NIL) certify(nodes.left(node));
+    if (nodes.right(node) != NIL) certify(nodes.right(node));
 }
 
-int KineticHanger::getRandomPriority() {
-    std::uniform_int_distribution<int> dist(1, 1000);
-    return dist(gen);
+template<class Stats>
+Trajectory BasicKineticHanger<Stats>::getRandomPriority() {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    return Trajectory::constant(dist(gen));
 }
 
-} 
+template class BasicKineticHanger<stats::None>;
+template class BasicKineticHanger<stats::Count>;
+
+}
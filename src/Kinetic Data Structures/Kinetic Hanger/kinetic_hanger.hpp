@@ -1,59 +1,90 @@
 #ifndef KINETIC_HANGER_HPP
 #define KINETIC_HANGER_HPP
 
+#include "../event_queue.hpp"
+#include "../node_pool.hpp"
+#include "../trajectory.hpp"
+#include "../../stats.hpp"
+
 #include <iostream>
 #include <vector>
-#include <queue>
-#include <memory>
 #include <random>
 #include <algorithm>
+#include <unordered_map>
 
 namespace kinetic {
 
-// Certificate structure representing failure conditions
-struct Certificate {
-    int element;   // The element associated with the certificate
-    int priority;  // Priority of the element
-    bool operator<(const Certificate &other) const {
-        return priority < other.priority;
-    }
-};
-
-// Node of the kinetic hanger tree
-class Node {
-public:
-    int element;
-    int priority;
-    std::unique_ptr<Node> left;
-    std::unique_ptr<Node> right;
-
-    Node(int elem, int pri)
-        : element(elem), priority(pri), left(nullptr), right(nullptr) {}
-};
-
-// Kinetic Hanger class
-class KineticHanger {
+// Kinetic Hanger class: a randomized kinetic heap whose priorities move
+// along trajectories. Nodes live in a NodePool (an element is stored as the
+// node's key) and all tree walks are iterative. A hash index from element
+// to handle finds any element without searching the tree, so remove costs
+// the expected O(log n) height. Each edge has a certificate keyed by the
+// time the child overtakes its parent; a failure swaps the two elements and
+// re-keys the edges around them.
+//
+// Stats is stats::None or stats::Count (see stats.hpp); both are
+// instantiated in kinetic_hanger.cpp. KineticHanger is the uncounted one.
+template<class Stats = stats::None>
+class BasicKineticHanger {
 public:
-    KineticHanger();
+    BasicKineticHanger();
 
+    // Elements get random constant priorities. Built in O(n) as the
+    // Cartesian tree of the priorities over the input order.
     void buildHanger(const std::vector<int>& elements);
     void insert(int element);
+    void insert(int element, const Trajectory& priority);
     void remove(int element);
+    // Builds the batch into a hanger of its own in O(m) and melds it in,
+    // recertifying only the meld path.
+    void insertBatch(const std::vector<int>& elements);
+    void insertBatch(const std::vector<int>& elements, const std::vector<Trajectory>& priorities);
+    void removeBatch(const std::vector<int>& elements);
+    bool contains(int element) const { return index.count(element) != 0; }
     bool isEmpty() const;
+    size_t size() const { return nodes.size(); }
+    // Moves the clock forward to t, processing every certificate failure on
+    // the way in time order. Throws std::invalid_argument if t is in the past.
+    void advance(double t);
+    double now() const { return currentTime; }
+    // All zero unless Stats is stats::Count.
+    KineticStats stats() const { return counters.snapshot(); }
+    void resetStats() { counters.reset(); }
 
 private:
-    std::unique_ptr<Node> root;
-    std::priority_queue<Certificate> eventQueue;
+    NodePool nodes;
+    Handle root = NIL;
+    EventQueue<Certificate> eventQueue;
+    double currentTime = 0;
+    stats::Counters<Stats, KineticStats> counters;
+    // Handles holding each element; kept in step whenever an element moves
+    // to another node
+    std::unordered_multimap<int, Handle> index;
 
     std::random_device rd;
     std::mt19937 gen;
 
-    std::unique_ptr<Node> hang(std::unique_ptr<Node> node, int element, int priority);
-    std::unique_ptr<Node> deleteNode(std::unique_ptr<Node> node, int element);
-    void updateCertificates(std::unique_ptr<Node>& node);
-    int getRandomPriority();
+    Handle allocateNode(int element, const Trajectory& priority);
+    // Records that the copy of element held by from now lives in to.
+    void moveIndex(int element, Handle from, Handle to);
+    void hang(int element, const Trajectory& priority);
+    // Melds two hangers along a random path; records the nodes whose parent
+    // edge changed in touched.
+    Handle meld(Handle a, Handle b, std::vector<Handle>& touched);
+    void deleteNode(int element);
+    // The certificate of node has failed: swap it with its parent.
+    void handleCertificateFailure(Handle node);
+    // Re-keys the certificate on the edge from node to its parent.
+    void certify(Handle node);
+    void dropCertificate(Handle node);
+    // Re-keys the certificates on both child edges of node.
+    void certifyChildren(Handle node);
+    double priorityNow(Handle node) const { return nodes.priority(node).at(currentTime); }
+    Trajectory getRandomPriority();
 };
 
+using KineticHanger = BasicKineticHanger<>;
+
 } // namespace kinetic
 
 #endif // KINETIC_HANGER_HPP
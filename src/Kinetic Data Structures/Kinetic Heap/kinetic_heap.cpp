@@ -0,0 +1,154 @@
+#include "kinetic_heap.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace kinetic {
+
+void KineticHeap::buildHeap(const std::vector<int>& keys, const std::vector<Trajectory>& priorities) {
+    if (keys.size() != priorities.size()) {
+        throw std::invalid_argument("KineticHeap::buildHeap: one priority per key required");
+    }
+    std::unordered_map<int, size_t> positions;
+    positions.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (!positions.emplace(keys[i], i).second) {
+            throw std::invalid_argument("KineticHeap::buildHeap: duplicate key");
+        }
+    }
+    this->keys = keys;
+    motions = priorities;
+    positionOf = std::move(positions);
+
+    // Floyd's heapify, then every edge certified at once
+    for (size_t i = this->keys.size() / 2; i-- > 0;) {
+        size_t current = i;
+        for (;;) {
+            size_t best = current;
+            for (size_t child = 2 * current + 1; child <= 2 * current + 2 && child < this->keys.size(); ++child) {
+                if (valueAt(child) > valueAt(best)) best = child;
+            }
+            if (best == current) break;
+            swapEntries(current, best);
+            current = best;
+        }
+    }
+    std::vector<std::pair<Certificate, uint32_t>> entries;
+    entries.reserve(this->keys.size());
+    for (size_t i = 1; i < this->keys.size(); ++i) {
+        size_t parent = (i - 1) / 2;
+        entries.push_back({{this->keys[i], failureTime(motions[parent], motions[i], currentTime)},
+                           static_cast<uint32_t>(i)});
+    }
+    eventQueue.build(std::move(entries));
+}
+
+void KineticHeap::insert(int key, const Trajectory& priority) {
+    if (positionOf.count(key)) {
+        throw std::invalid_argument("KineticHeap::insert: key already present");
+    }
+    keys.push_back(key);
+    motions.push_back(priority);
+    positionOf.emplace(key, keys.size() - 1);
+    for (size_t i : sift(keys.size() - 1)) certifyAround(i);
+}
+
+void KineticHeap::remove(int key) {
+    auto found = positionOf.find(key);
+    if (found == positionOf.end()) return;
+    size_t i = found->second;
+    size_t last = keys.size() - 1;
+    if (i != last) swapEntries(i, last);
+    positionOf.erase(key);
+    keys.pop_back();
+    motions.pop_back();
+    eventQueue.erase(static_cast<uint32_t>(last));
+    if (i == last) return;
+    for (size_t changed : sift(i)) certifyAround(changed);
+}
+
+void KineticHeap::setPriority(int key, const Trajectory& priority) {
+    auto found = positionOf.find(key);
+    if (found == positionOf.end()) return;
+    size_t i = found->second;
+    motions[i] = priority;
+    for (size_t changed : sift(i)) certifyAround(changed);
+}
+
+int KineticHeap::currentMax() const {
+    if (isEmpty()) throw std::out_of_range("KineticHeap::currentMax: heap is empty");
+    return keys[0];
+}
+
+double KineticHeap::currentMaxPriority() const {
+    if (isEmpty()) throw std::out_of_range("KineticHeap::currentMaxPriority: heap is empty");
+    return valueAt(0);
+}
+
+void KineticHeap::advance(double t) {
+    if (t < currentTime) {
+        throw std::invalid_argument("KineticHeap::advance: time must not go backwards");
+    }
+    processEvents(eventQueue, currentTime, t, [this](uint32_t i) { handleCertificateFailure(i); });
+}
+
+void KineticHeap::swapEntries(size_t i, size_t j) {
+    std::swap(keys[i], keys[j]);
+    std::swap(motions[i], motions[j]);
+    positionOf[keys[i]] = i;
+    positionOf[keys[j]] = j;
+}
+
+std::vector<size_t> KineticHeap::sift(size_t i) {
+    std::vector<size_t> changed;
+    while (i > 0 && valueAt(i) > valueAt((i - 1) / 2)) {
+        size_t parent = (i - 1) / 2;
+        swapEntries(i, parent);
+        changed.push_back(i);
+        i = parent;
+    }
+    if (!changed.empty()) {
+        changed.push_back(i);
+        return changed;
+    }
+    for (;;) {
+        size_t best = i;
+        for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < keys.size(); ++child) {
+            if (valueAt(child) > valueAt(best)) best = child;
+        }
+        if (best == i) break;
+        swapEntries(i, best);
+        changed.push_back(i);
+        i = best;
+    }
+    changed.push_back(i);
+    return changed;
+}
+
+void KineticHeap::certify(size_t i) {
+    if (i == 0) {
+        // The root has no parent edge to guard
+        eventQueue.erase(0);
+        return;
+    }
+    size_t parent = (i - 1) / 2;
+    eventQueue.push(static_cast<uint32_t>(i), {keys[i], failureTime(motions[parent], motions[i], currentTime)});
+}
+
+void KineticHeap::certifyAround(size_t i) {
+    certify(i);
+    for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < keys.size(); ++child) {
+        certify(child);
+    }
+}
+
+void KineticHeap::handleCertificateFailure(size_t i) {
+    // The child has just caught up with its parent: swap them, which
+    // changes the edge above the parent and every edge below either
+    size_t parent = (i - 1) / 2;
+    swapEntries(i, parent);
+    certifyAround(parent);
+    certifyAround(i);
+}
+
+} // namespace kinetic
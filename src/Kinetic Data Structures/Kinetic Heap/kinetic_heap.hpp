@@ -0,0 +1,71 @@
+#ifndef KINETIC_HEAP_HPP
+#define KINETIC_HEAP_HPP
+
+#include "../event_queue.hpp"
+#include "../trajectory.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace kinetic {
+
+// Kinetic Heap class: an implicit binary max-heap of moving priorities
+// (position i has children 2i+1 and 2i+2) with one certificate per
+// parent-child edge, named by the child's position. A failure swaps the two
+// elements, which re-keys the O(1) edges around them for O(log n) per event;
+// insert and remove sift along one path and re-key the edges on it, O(log^2 n).
+// Unlike the tournament it keeps no winner nodes, so it holds n entries
+// rather than 2n. Keys name elements and must be distinct.
+class KineticHeap {
+public:
+    KineticHeap() = default;
+
+    // Replaces the contents in O(n). Throws std::invalid_argument unless
+    // there is one priority per key and the keys are distinct.
+    void buildHeap(const std::vector<int>& keys, const std::vector<Trajectory>& priorities);
+    // Throws std::invalid_argument if key is already present.
+    void insert(int key, const Trajectory& priority);
+    void remove(int key);
+    // Gives a present key a new trajectory from now on.
+    void setPriority(int key, const Trajectory& priority);
+    bool contains(int key) const { return positionOf.count(key) != 0; }
+    bool isEmpty() const { return keys.empty(); }
+    size_t size() const { return keys.size(); }
+    size_t certificateCount() const { return eventQueue.size(); }
+
+    // Key and priority of the current maximum in O(1). Throw
+    // std::out_of_range if the heap is empty.
+    int currentMax() const;
+    double currentMaxPriority() const;
+
+    // Moves the clock forward to t, swapping elements at every certificate
+    // failure on the way in time order. Throws std::invalid_argument if t
+    // is in the past.
+    void advance(double t);
+    double now() const { return currentTime; }
+
+private:
+    // In heap order
+    std::vector<int> keys;
+    std::vector<Trajectory> motions;
+    std::unordered_map<int, size_t> positionOf;
+    EventQueue<Certificate> eventQueue;
+    double currentTime = 0;
+
+    double valueAt(size_t i) const { return motions[i].at(currentTime); }
+    void swapEntries(size_t i, size_t j);
+    // Moves the entry at i up or down to its place and returns the positions
+    // whose contents changed (at least i).
+    std::vector<size_t> sift(size_t i);
+    // Re-keys the certificate on the edge from position i to its parent.
+    void certify(size_t i);
+    // Re-keys the edges from i to its parent and to its children.
+    void certifyAround(size_t i);
+    void handleCertificateFailure(size_t i);
+};
+
+} // namespace kinetic
+
+#endif // KINETIC_HEAP_HPP
@@ -1,133 +1,496 @@
 #include "kinetic_heater.hpp"
 
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+
 namespace kinetic {
 
-KineticHeater::KineticHeater() : root(nullptr), gen(rd()) {}
+template<class Stats>
+BasicKineticHeater<Stats>::BasicKineticHeater() : gen(rd()) {}
 
-void KineticHeater::buildHeater(const std::vector<int>& keys) {
-    root.reset();
-    while (!eventQueue.empty()) eventQueue.pop();
+template<class Stats>
+void BasicKineticHeater<Stats>::buildHeater(const std::vector<int>& keys) {
+    nodes.clear();
+    root = NIL;
+    eventQueue.clear();
+    nodes.reserve(keys.size());
 
-    // Insert each key with a random priority to build the tree
-    for (int key : keys) {
-        root = insertNode(std::move(root), key, getRandomPriority());
+    // With the keys in order the treap is the Cartesian tree of the
+    // priorities, which one stack pass builds
+    std::vector<int> sorted(keys);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<Handle> order;
+    order.reserve(sorted.size());
+    for (int key : sorted) {
+        order.push_back(nodes.allocate(key, getRandomPriority()));
     }
+    root = nodes.linkCartesian(order, currentTime);
+    certifyAll();
+}
 
-    // Update the event queue (certificates)
-    updateCertificates(root);
+template<class Stats>
+void BasicKineticHeater<Stats>::insert(int key) {
+    insertNode(key, getRandomPriority());
 }
 
-void KineticHeater::insert(int key) {
-    int priority = getRandomPriority();
-    root = insertNode(std::move(root), key, priority);
-    updateCertificates(root);
+template<class Stats>
+void BasicKineticHeater<Stats>::insert(int key, const Trajectory& priority) {
+    insertNode(key, priority);
 }
 
-void KineticHeater::remove(int key) {
-    root = deleteNode(std::move(root), key);
-    updateCertificates(root);
+template<class Stats>
+void BasicKineticHeater<Stats>::remove(int key) {
+    deleteNode(key);
 }
 
-bool KineticHeater::isEmpty() const {
-    return root == nullptr;
+template<class Stats>
+void BasicKineticHeater<Stats>::insertBatch(const std::vector<int>& keys, unsigned threads) {
+    std::vector<Trajectory> priorities;
+    priorities.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        priorities.push_back(getRandomPriority());
+    }
+    insertBatch(keys, priorities, threads);
 }
 
-std::unique_ptr<Node> KineticHeater::insertNode(std::unique_ptr<Node> node, int key, int priority) {
-    if (!node) return std::make_unique<Node>(key, priority);
+template<class Stats>
+void BasicKineticHeater<Stats>::insertBatch(const std::vector<int>& keys, const std::vector<Trajectory>& priorities,
+                                           unsigned threads) {
+    if (keys.size() != priorities.size()) {
+        throw std::invalid_argument("KineticHeater::insertBatch: one priority per key required");
+    }
+    std::vector<size_t> byKey(keys.size());
+    for (size_t i = 0; i < byKey.size(); ++i) byKey[i] = i;
+    std::stable_sort(byKey.begin(), byKey.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
 
-    if (key < node->key) {
-        node->left = insertNode(std::move(node->left), key, priority);
-        if (node->left->priority > node->priority) {
-            node = rotateRight(std::move(node));
-        }
-    } else {
-        node->right = insertNode(std::move(node->right), key, priority);
-        if (node->right->priority > node->priority) {
-            node = rotateLeft(std::move(node));
+    // All nodes are allocated up front, so the pool does not grow while
+    // parallel merges write to it
+    BatchLog log;
+    log.touched.reserve(keys.size());
+    for (size_t i : byKey) {
+        log.touched.push_back(nodes.allocate(keys[i], priorities[i]));
+    }
+    Handle batch = nodes.linkCartesian(log.touched, currentTime);
+    finishBatch(unite(root, batch, log, forkDepthFor(threads)), log);
+}
+
+template<class Stats>
+void BasicKineticHeater<Stats>::removeBatch(const std::vector<int>& keys, unsigned threads) {
+    std::vector<int> sorted(keys);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    BatchLog log;
+    Handle newRoot = subtract(root, sorted.data(), sorted.data() + sorted.size(), log, forkDepthFor(threads));
+    finishBatch(newRoot, log);
+}
+
+template<class Stats>
+bool BasicKineticHeater<Stats>::isEmpty() const {
+    return root == NIL;
+}
+
+template<class Stats>
+void BasicKineticHeater<Stats>::advance(double t) {
+    if (t < currentTime) {
+        throw std::invalid_argument("KineticHeater::advance: time must not go backwards");
+    }
+    processEvents(eventQueue, currentTime, t, [this](Handle node) { handleCertificateFailure(node); });
+}
+
+template<class Stats>
+bool BasicKineticHeater<Stats>::above(Handle a, Handle b) const {
+    return nodes.priority(a).at(currentTime) > nodes.priority(b).at(currentTime);
+}
+
+template<class Stats>
+void BasicKineticHeater<Stats>::insertNode(int key, const Trajectory& priority) {
+    Handle node = nodes.allocate(key, priority);
+    if (root == NIL) {
+        root = node;
+        return;
+    }
+
+    // Descend to the leaf position, then rotate the new node up while it
+    // outranks its parent
+    Handle parent = root;
+    for (;;) {
+        Handle& child = key < nodes.key(parent) ? nodes.left(parent) : nodes.right(parent);
+        if (child == NIL) {
+            child = node;
+            break;
         }
+        parent = child;
+    }
+    nodes.parent(node) = parent;
+    certify(node);
+    while (nodes.parent(node) != NIL && above(node, nodes.parent(node))) {
+        rotateUp(node);
     }
-    return node;
 }
 
-std::unique_ptr<Node> KineticHeater::deleteNode(std::unique_ptr<Node> node, int key) {
-    if (!node) return nullptr;
+template<class Stats>
+void BasicKineticHeater<Stats>::deleteNode(int key) {
+    Handle node = root;
+    while (node != NIL && nodes.key(node) != key) {
+        node = key < nodes.key(node) ? nodes.left(node) : nodes.right(node);
+    }
+    if (node == NIL) return;
 
-    if (key < node->key) {
-        node->left = deleteNode(std::move(node->left), key);
-    } else if (key > node->key) {
-        node->right = deleteNode(std::move(node->right), key);
+    // Rotate the node down below its higher-priority child until it has at
+    // most one child, then splice it out
+    while (nodes.left(node) != NIL && nodes.right(node) != NIL) {
+        Handle left = nodes.left(node);
+        Handle right = nodes.right(node);
+        rotateUp(above(left, right) ? left : right);
+    }
+    Handle child = nodes.left(node) != NIL ? nodes.left(node) : nodes.right(node);
+    Handle parent = nodes.parent(node);
+    if (child != NIL) nodes.parent(child) = parent;
+    if (parent == NIL) {
+        root = child;
+    } else if (nodes.left(parent) == node) {
+        nodes.left(parent) = child;
     } else {
-        // Node to delete is found
-        if (!node->left) return std::move(node->right);
-        if (!node->right) return std::move(node->left);
+        nodes.right(parent) = child;
+    }
+    if (child != NIL) certify(child);
+    dropCertificate(node);
+    nodes.release(node);
+}
 
-        if (node->left->priority > node->right->priority) {
-            node = rotateRight(std::move(node));
-            node->right = deleteNode(std::move(node->right), key);
-        } else {
-            node = rotateLeft(std::move(node));
-            node->left = deleteNode(std::move(node->left), key);
-        }
+template<class Stats>
+void BasicKineticHeater<Stats>::rotateUp(Handle node) {
+    Handle parent = nodes.parent(node);
+    Handle grandparent = nodes.parent(parent);
+    Handle moved;  // The subtree that changes sides
+    if (nodes.left(parent) == node) {
+        moved = nodes.right(node);
+        nodes.left(parent) = moved;
+        nodes.right(node) = parent;
+    } else {
+        moved = nodes.left(node);
+        nodes.right(parent) = moved;
+        nodes.left(node) = parent;
     }
-    return node;
+    if (moved != NIL) nodes.parent(moved) = parent;
+    nodes.parent(parent) = node;
+    nodes.parent(node) = grandparent;
+    if (grandparent == NIL) {
+        root = node;
+    } else if (nodes.left(grandparent) == parent) {
+        nodes.left(grandparent) = node;
+    } else {
+        nodes.right(grandparent) = node;
+    }
+
+    // A rotation changes exactly three edges
+    counters.update([](KineticStats& s) { ++s.rotations; });
+    certify(node);
+    certify(parent);
+    if (moved != NIL) certify(moved);
 }
 
-std::unique_ptr<Node> KineticHeater::rotateLeft(std::unique_ptr<Node> node) {
-    auto newRoot = std::move(node->right);
-    node->right = std::move(newRoot->left);
-    newRoot->left = std::move(node);
-    return newRoot;
+template<class Stats>
+void BasicKineticHeater<Stats>::handleCertificateFailure(Handle node) {
+    counters.update([](KineticStats& s) { ++s.events; });
+    if (nodes.parent(node) == NIL) {
+        dropCertificate(node);
+        return;
+    }
+
+    // The child has just caught up with its parent; rotating it up swaps
+    // the pair and re-keys the three edges around them
+    rotateUp(node);
 }
 
-std::unique_ptr<Node> KineticHeater::rotateRight(std::unique_ptr<Node> node) {
-    auto newRoot = std::move(node->left);
-    node->left = std::move(newRoot->right);
-    newRoot->right = std::move(node);
-    return newRoot;
+template<class Stats>
+void BasicKineticHeater<Stats>::certify(Handle node) {
+    Handle parent = nodes.parent(node);
+    if (parent == NIL) {
+        // The root has no parent edge to guard
+        dropCertificate(node);
+        return;
+    }
+    counters.update([](KineticStats& s) { ++s.certificatesPushed; });
+    eventQueue.push(node, {nodes.key(node), failureTime(nodes.priority(parent), nodes.priority(node), currentTime)});
 }
 
-void KineticHeater::handleCertificateFailure(std::unique_ptr<Node>& node) {
-    if (!node) return;
+template<class Stats>
+void BasicKineticHeater<Stats>::dropCertificate(Handle node) {
+    counters.update([&](KineticStats& s) { s.certificatesInvalidated += eventQueue.contains(node); });
+    eventQueue.erase(node);
+}
 
-    // Check priority properties and handle rotations on failure
-    if (node->left && node->left->priority > node->priority) {
-        node = rotateRight(std::move(node));
-    } else if (node->right && node->right->priority > node->priority) {
-        node = rotateLeft(std::move(node));
+template<class Stats>
+void BasicKineticHeater<Stats>::certifyAll() {
+    auto entries = nodes.certificates(root, currentTime);
+    counters.update([&](KineticStats& s) { s.certificatesPushed += entries.size(); });
+    eventQueue.build(std::move(entries));
+}
+
+template<class Stats>
+void BasicKineticHeater<Stats>::BatchLog::append(BatchLog&& other) {
+    touched.insert(touched.end(), other.touched.begin(), other.touched.end());
+    removed.insert(removed.end(), other.removed.begin(), other.removed.end());
+}
+
+template<class Stats>
+void BasicKineticHeater<Stats>::setLeft(Handle parent, Handle child, BatchLog& log) {
+    if (nodes.left(parent) == child) return;
+    nodes.left(parent) = child;
+    if (child != NIL) {
+        nodes.parent(child) = parent;
+        log.touched.push_back(child);
+    }
+}
+
+template<class Stats>
+void BasicKineticHeater<Stats>::setRight(Handle parent, Handle child, BatchLog& log) {
+    if (nodes.right(parent) == child) return;
+    nodes.right(parent) = child;
+    if (child != NIL) {
+        nodes.parent(child) = parent;
+        log.touched.push_back(child);
+    }
+}
+
+template<class Stats>
+std::pair<Handle, Handle> BasicKineticHeater<Stats>::split(Handle node, int key, BatchLog& log) {
+    // Walks down once; lessTail's right and restTail's left are the open
+    // slots the next node on each side hangs from.
+    Handle less = NIL;
+    Handle rest = NIL;
+    Handle lessTail = NIL;
+    Handle restTail = NIL;
+    while (node != NIL) {
+        if (nodes.key(node) < key) {
+            if (lessTail == NIL) less = node;
+            else setRight(lessTail, node, log);
+            lessTail = node;
+            node = nodes.right(node);
+        } else {
+            if (restTail == NIL) rest = node;
+            else setLeft(restTail, node, log);
+            restTail = node;
+            node = nodes.left(node);
+        }
     }
+    if (lessTail != NIL) setRight(lessTail, NIL, log);
+    if (restTail != NIL) setLeft(restTail, NIL, log);
+    return {less, rest};
+}
+
+template<class Stats>
+Handle BasicKineticHeater<Stats>::join(Handle a, Handle b, BatchLog& log) {
+    // Zips the right spine of a with the left spine of b; the higher root
+    // takes the open slot and the other tree carries on below it.
+    Handle top = NIL;
+    Handle slot = NIL;
+    bool slotIsLeft = false;
+    auto attach = [&](Handle child) {
+        if (slot == NIL) top = child;
+        else if (slotIsLeft) setLeft(slot, child, log);
+        else setRight(slot, child, log);
+    };
+    while (a != NIL && b != NIL) {
+        if (above(b, a)) {
+            attach(b);
+            slot = b;
+            slotIsLeft = true;
+            b = nodes.left(b);
+        } else {
+            attach(a);
+            slot = a;
+            slotIsLeft = false;
+            a = nodes.right(a);
+        }
+    }
+    attach(a != NIL ? a : b);
+    return top;
+}
 
-    // Recompute certificates after handling failure
-    updateCertificates(node);
+template<class Stats>
+Handle BasicKineticHeater<Stats>::unite(Handle a, Handle b, BatchLog& log, unsigned forkDepth) {
+    if (forkDepth == 0) return uniteSequential(a, b, log);
+    if (a == NIL) return b;
+    if (b == NIL) return a;
+    if (above(b, a)) std::swap(a, b);
+
+    // a stays on top; b is split around it and each side merged below
+    auto [less, rest] = split(b, nodes.key(a), log);
+    Handle left = nodes.left(a);
+    Handle right = nodes.right(a);
+    BatchLog leftLog;
+    auto pending = std::async(std::launch::async,
+                              [&] { return unite(left, less, leftLog, forkDepth - 1); });
+    Handle newRight = unite(right, rest, log, forkDepth - 1);
+    Handle newLeft = pending.get();
+    log.append(std::move(leftLog));
+    setLeft(a, newLeft, log);
+    setRight(a, newRight, log);
+    return a;
 }
 
-void KineticHeater::updateCertificates(std::unique_ptr<Node>& node) {
-    if (!node) return;
+template<class Stats>
+Handle BasicKineticHeater<Stats>::uniteSequential(Handle a, Handle b, BatchLog& log) {
+    // unite() with the recursion on an explicit stack, which a treap that
+    // has degenerated into a path would otherwise overflow. A frame is the
+    // root that stays on top and the two sides of the other tree; its
+    // children are merged left then right and linked once both are done.
+    struct Frame {
+        Handle node;
+        Handle less;
+        Handle rest;
+        Handle newLeft;
+        int stage;
+    };
+    std::vector<Frame> stack;
+    Handle result = NIL;
+    auto enter = [&](Handle x, Handle y) {
+        if (x == NIL || y == NIL) {
+            result = x != NIL ? x : y;
+            return;
+        }
+        if (above(y, x)) std::swap(x, y);
+        auto [less, rest] = split(y, nodes.key(x), log);
+        stack.push_back({x, less, rest, NIL, 0});
+    };
 
-    // Clear existing certificates
-    while (!eventQueue.empty()) eventQueue.pop();
+    enter(a, b);
+    while (!stack.empty()) {
+        // enter() may grow the stack, so frame is not used after it
+        Frame& frame = stack.back();
+        if (frame.stage == 0) {
+            frame.stage = 1;
+            enter(nodes.left(frame.node), frame.less);
+        } else if (frame.stage == 1) {
+            frame.newLeft = result;
+            frame.stage = 2;
+            enter(nodes.right(frame.node), frame.rest);
+        } else {
+            Frame done = frame;
+            stack.pop_back();
+            setLeft(done.node, done.newLeft, log);
+            setRight(done.node, result, log);
+            result = done.node;
+        }
+    }
+    return result;
+}
 
-    // Traverse and create certificates for each edge in the tree
-    std::queue<Node*> queue;
-    queue.push(node.get());
+template<class Stats>
+Handle BasicKineticHeater<Stats>::subtract(Handle node, const int* first, const int* last, BatchLog& log,
+                                          unsigned forkDepth) {
+    if (forkDepth == 0) return subtractSequential(node, first, last, log);
+    if (node == NIL || first == last) return node;
+    const int key = nodes.key(node);
+    const int* mid = std::lower_bound(first, last, key);
+    const bool hit = mid != last && *mid == key;
+    const int* after = hit ? mid + 1 : mid;
 
-    while (!queue.empty()) {
-        Node* current = queue.front();
-        queue.pop();
+    Handle left = nodes.left(node);
+    Handle right = nodes.right(node);
+    BatchLog leftLog;
+    auto pending = std::async(std::launch::async,
+                              [&] { return subtract(left, first, mid, leftLog, forkDepth - 1); });
+    Handle newRight = subtract(right, after, last, log, forkDepth - 1);
+    Handle newLeft = pending.get();
+    log.append(std::move(leftLog));
+    if (hit) {
+        log.removed.push_back(node);
+        return join(newLeft, newRight, log);
+    }
+    setLeft(node, newLeft, log);
+    setRight(node, newRight, log);
+    return node;
+}
 
-        if (current->left) {
-            eventQueue.push({current->key, current->priority});
-            queue.push(current->left.get());
+template<class Stats>
+Handle BasicKineticHeater<Stats>::subtractSequential(Handle node, const int* first, const int* last,
+                                                    BatchLog& log) {
+    // subtract() on an explicit stack, as in uniteSequential(). A frame is
+    // a node, the keys below it split around its own, and whether it is
+    // one of them; a hit is joined out once both children are done.
+    struct Frame {
+        Handle node;
+        const int* first;
+        const int* mid;
+        const int* after;
+        const int* last;
+        bool hit;
+        Handle newLeft;
+        int stage;
+    };
+    std::vector<Frame> stack;
+    Handle result = NIL;
+    auto enter = [&](Handle x, const int* from, const int* to) {
+        if (x == NIL || from == to) {
+            result = x;
+            return;
         }
-        if (current->right) {
-            eventQueue.push({current->key, current->priority});
-            queue.push(current->right.get());
+        const int key = nodes.key(x);
+        const int* mid = std::lower_bound(from, to, key);
+        const bool hit = mid != to && *mid == key;
+        stack.push_back({x, from, mid, hit ? mid + 1 : mid, to, hit, NIL, 0});
+    };
+
+    enter(node, first, last);
+    while (!stack.empty()) {
+        // enter() may grow the stack, so frame is not used after it
+        Frame& frame = stack.back();
+        if (frame.stage == 0) {
+            frame.stage = 1;
+            enter(nodes.left(frame.node), frame.first, frame.mid);
+        } else if (frame.stage == 1) {
+            frame.newLeft = result;
+            frame.stage = 2;
+            enter(nodes.right(frame.node), frame.after, frame.last);
+        } else {
+            Frame done = frame;
+            stack.pop_back();
+            if (done.hit) {
+                log.removed.push_back(done.node);
+                result = join(done.newLeft, result, log);
+            } else {
+                setLeft(done.node, done.newLeft, log);
+                setRight(done.node, result, log);
+                result = done.node;
+            }
         }
     }
+    return result;
 }
 
-int KineticHeater::getRandomPriority() {
-    std::uniform_int_distribution<int> dist(1, 1000);
-    return dist(gen);
+template<class Stats>
+void BasicKineticHeater<Stats>::finishBatch(Handle newRoot, BatchLog& log) {
+    root = newRoot;
+    if (root != NIL) nodes.parent(root) = NIL;
+    std::sort(log.removed.begin(), log.removed.end());
+    for (Handle h : log.touched) {
+        if (!std::binary_search(log.removed.begin(), log.removed.end(), h)) certify(h);
+    }
+    if (root != NIL) certify(root);
+    for (Handle h : log.removed) {
+        dropCertificate(h);
+        nodes.release(h);
+    }
 }
 
+template<class Stats>
+unsigned BasicKineticHeater<Stats>::forkDepthFor(unsigned threads) {
+    unsigned depth = 0;
+    while ((2u << depth) <= threads) ++depth;
+    return depth;
+}
+
+template<class Stats>
+Trajectory BasicKineticHeater<Stats>::getRandomPriority() {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    return Trajectory::constant(dist(gen));
+}
+
+template class BasicKineticHeater<stats::None>;
+template class BasicKineticHeater<stats::Count>;
+
 } // namespace kinetic
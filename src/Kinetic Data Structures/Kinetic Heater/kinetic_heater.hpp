@@ -1,60 +1,110 @@
 #ifndef KINETIC_HEATER_HPP
 #define KINETIC_HEATER_HPP
 
+#include "../event_queue.hpp"
+#include "../node_pool.hpp"
+#include "../trajectory.hpp"
+#include "../../stats.hpp"
+
+#include <cstdint>
 #include <iostream>
-#include <memory>
-#include <queue>
 #include <random>
+#include <utility>
 #include <vector>
 
 namespace kinetic {
 
-struct Certificate {
-    int key;
-    int priority;
-    bool operator<(const Certificate &other) const {
-        return priority < other.priority;
-    }
-};
-
-// Node in the kinetic heater, storing both a key and a priority.
-class Node {
+// Kinetic Heater class: a treap on keys whose priorities move along
+// trajectories. Nodes live in a NodePool and every edge carries a
+// certificate in an addressable event queue, keyed by the time the child
+// overtakes its parent. An update walks the tree iteratively and re-keys
+// only the certificates on edges it changed, so insert and remove cost
+// O(log n) expected; advance() pays only for the events that fire.
+//
+// Stats is stats::None or stats::Count (see stats.hpp); both are
+// instantiated in kinetic_heater.cpp. KineticHeater is the uncounted one.
+template<class Stats = stats::None>
+class BasicKineticHeater {
 public:
-    int key;
-    int priority;
-    std::unique_ptr<Node> left;
-    std::unique_ptr<Node> right;
-
-    Node(int k, int p)
-        : key(k), priority(p), left(nullptr), right(nullptr) {}
-};
-
-// Kinetic Heater class
-class KineticHeater {
-public:
-    KineticHeater();
+    BasicKineticHeater();
 
+    // Keys get random constant priorities. Builds the treap bottom-up from
+    // the sorted keys in O(n) after sorting.
     void buildHeater(const std::vector<int>& keys);
     void insert(int key);
+    void insert(int key, const Trajectory& priority);
     void remove(int key);
+    // Batch updates through treap union and difference: the batch is built
+    // into a treap of its own and merged with split/join, touching
+    // O(m log(n/m + 1)) nodes for a batch of m. With threads > 1 the two
+    // halves below each merged root are combined in parallel.
+    void insertBatch(const std::vector<int>& keys, unsigned threads = 1);
+    void insertBatch(const std::vector<int>& keys, const std::vector<Trajectory>& priorities,
+                     unsigned threads = 1);
+    // Removes one occurrence of every distinct key in the batch.
+    void removeBatch(const std::vector<int>& keys, unsigned threads = 1);
     bool isEmpty() const;
+    // Moves the clock forward to t, repairing the tree at every certificate
+    // failure on the way in time order. Throws std::invalid_argument if t
+    // is in the past.
+    void advance(double t);
+    double now() const { return currentTime; }
+    size_t size() const { return nodes.size(); }
+    size_t certificateCount() const { return eventQueue.size(); }
+    // All zero unless Stats is stats::Count.
+    KineticStats stats() const { return counters.snapshot(); }
+    void resetStats() { counters.reset(); }
 
 private:
-    std::unique_ptr<Node> root;
-    std::priority_queue<Certificate> eventQueue;
+    NodePool nodes;
+    Handle root = NIL;
+    EventQueue<Certificate> eventQueue;
+    double currentTime = 0;
+    stats::Counters<Stats, KineticStats> counters;
 
     std::random_device rd;
     std::mt19937 gen;
 
-    std::unique_ptr<Node> rotateLeft(std::unique_ptr<Node> node);
-    std::unique_ptr<Node> rotateRight(std::unique_ptr<Node> node);
-    void handleCertificateFailure(std::unique_ptr<Node>& node);
-    std::unique_ptr<Node> insertNode(std::unique_ptr<Node> node, int key, int priority);
-    std::unique_ptr<Node> deleteNode(std::unique_ptr<Node> node, int key);
-    void updateCertificates(std::unique_ptr<Node>& node);
-    int getRandomPriority();
+    // Nodes whose parent edge changed and nodes taken out during a batch;
+    // the event queue and the pool are only updated once the batch is done.
+    struct BatchLog {
+        std::vector<Handle> touched;
+        std::vector<Handle> removed;
+        void append(BatchLog&& other);
+    };
+
+    // Rotates node above its parent.
+    void rotateUp(Handle node);
+    // The certificate of node has failed: restore the heap order on its edge.
+    void handleCertificateFailure(Handle node);
+    void insertNode(int key, const Trajectory& priority);
+    // Whether a outranks b at the current time
+    bool above(Handle a, Handle b) const;
+    void deleteNode(int key);
+    // Re-keys the certificate on the edge from node to its parent.
+    void certify(Handle node);
+    void dropCertificate(Handle node);
+    // Builds the event queue from scratch for the whole tree.
+    void certifyAll();
+    void setLeft(Handle parent, Handle child, BatchLog& log);
+    void setRight(Handle parent, Handle child, BatchLog& log);
+    // (keys < key, keys >= key)
+    std::pair<Handle, Handle> split(Handle node, int key, BatchLog& log);
+    // Every key in a is at most every key in b
+    Handle join(Handle a, Handle b, BatchLog& log);
+    // Fork on the top forkDepth levels, then hand over to the sequential
+    // versions, which keep their work on the heap rather than the call stack.
+    Handle unite(Handle a, Handle b, BatchLog& log, unsigned forkDepth);
+    Handle uniteSequential(Handle a, Handle b, BatchLog& log);
+    Handle subtract(Handle node, const int* first, const int* last, BatchLog& log, unsigned forkDepth);
+    Handle subtractSequential(Handle node, const int* first, const int* last, BatchLog& log);
+    void finishBatch(Handle newRoot, BatchLog& log);
+    static unsigned forkDepthFor(unsigned threads);
+    Trajectory getRandomPriority();
 };
 
+using KineticHeater = BasicKineticHeater<>;
+
 } // namespace kinetic
 
 #endif // KINETIC_HEATER_HPP
@@ -0,0 +1,163 @@
+#include "kinetic_tournament.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace kinetic {
+
+void KineticTournament::buildTournament(const std::vector<int>& keys, const std::vector<Trajectory>& priorities) {
+    if (keys.size() != priorities.size()) {
+        throw std::invalid_argument("KineticTournament::buildTournament: one priority per key required");
+    }
+    std::unordered_map<int, uint32_t> slots;
+    slots.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (!slots.emplace(keys[i], static_cast<uint32_t>(i)).second) {
+            throw std::invalid_argument("KineticTournament::buildTournament: duplicate key");
+        }
+    }
+
+    capacity = 1;
+    while (capacity < keys.size()) capacity *= 2;
+    this->keys = keys;
+    this->keys.resize(capacity);
+    motions = priorities;
+    motions.resize(capacity);
+    slotOf = std::move(slots);
+    freeSlots.clear();
+    for (size_t slot = capacity; slot-- > keys.size();) {
+        freeSlots.push_back(static_cast<uint32_t>(slot));
+    }
+    winners.assign(2 * capacity, EMPTY);
+    for (size_t slot = 0; slot < keys.size(); ++slot) {
+        winners[capacity + slot] = static_cast<uint32_t>(slot);
+    }
+    rebuild();
+}
+
+void KineticTournament::insert(int key, const Trajectory& priority) {
+    if (slotOf.count(key)) {
+        throw std::invalid_argument("KineticTournament::insert: key already present");
+    }
+    if (freeSlots.empty()) grow();
+    uint32_t slot = freeSlots.back();
+    freeSlots.pop_back();
+    keys[slot] = key;
+    motions[slot] = priority;
+    slotOf.emplace(key, slot);
+    winners[capacity + slot] = slot;
+    replay((capacity + slot) / 2, false);
+}
+
+void KineticTournament::remove(int key) {
+    auto found = slotOf.find(key);
+    if (found == slotOf.end()) return;
+    uint32_t slot = found->second;
+    slotOf.erase(found);
+    freeSlots.push_back(slot);
+    winners[capacity + slot] = EMPTY;
+    replay((capacity + slot) / 2, false);
+}
+
+void KineticTournament::setPriority(int key, const Trajectory& priority) {
+    auto found = slotOf.find(key);
+    if (found == slotOf.end()) return;
+    uint32_t slot = found->second;
+    motions[slot] = priority;
+    replay((capacity + slot) / 2, true);
+}
+
+int KineticTournament::currentMax() const {
+    if (isEmpty()) throw std::out_of_range("KineticTournament::currentMax: tournament is empty");
+    return keys[winners[1]];
+}
+
+double KineticTournament::currentMaxPriority() const {
+    if (isEmpty()) throw std::out_of_range("KineticTournament::currentMaxPriority: tournament is empty");
+    return valueOf(winners[1]);
+}
+
+void KineticTournament::advance(double t) {
+    if (t < currentTime) {
+        throw std::invalid_argument("KineticTournament::advance: time must not go backwards");
+    }
+    processEvents(eventQueue, currentTime, t, [this](uint32_t node) { handleCertificateFailure(node); });
+}
+
+uint32_t KineticTournament::playMatch(size_t node) const {
+    uint32_t a = winners[2 * node];
+    uint32_t b = winners[2 * node + 1];
+    if (a == EMPTY) return b;
+    if (b == EMPTY) return a;
+    return valueOf(b) > valueOf(a) ? b : a;
+}
+
+void KineticTournament::certify(size_t node) {
+    uint32_t a = winners[2 * node];
+    uint32_t b = winners[2 * node + 1];
+    if (a == EMPTY || b == EMPTY) {
+        // A walkover cannot be overturned
+        eventQueue.erase(static_cast<uint32_t>(node));
+        return;
+    }
+    uint32_t winner = winners[node];
+    uint32_t loser = winner == a ? b : a;
+    eventQueue.push(static_cast<uint32_t>(node),
+                    {keys[winner], failureTime(motions[winner], motions[loser], currentTime)});
+}
+
+void KineticTournament::replay(size_t node, bool toRoot) {
+    for (; node >= 1; node /= 2) {
+        uint32_t previous = winners[node];
+        winners[node] = playMatch(node);
+        // The loser may have changed even when the winner did not
+        certify(node);
+        if (!toRoot && winners[node] == previous) break;
+    }
+}
+
+void KineticTournament::rebuild() {
+    std::vector<std::pair<Certificate, uint32_t>> entries;
+    entries.reserve(slotOf.size());
+    for (size_t node = capacity; node-- > 1;) {
+        winners[node] = playMatch(node);
+        uint32_t a = winners[2 * node];
+        uint32_t b = winners[2 * node + 1];
+        if (a == EMPTY || b == EMPTY) continue;
+        uint32_t winner = winners[node];
+        uint32_t loser = winner == a ? b : a;
+        entries.push_back({{keys[winner], failureTime(motions[winner], motions[loser], currentTime)},
+                           static_cast<uint32_t>(node)});
+    }
+    eventQueue.build(std::move(entries));
+}
+
+void KineticTournament::grow() {
+    // Doubling moves every leaf, so the tree is rebuilt; amortized O(1)
+    // per insert
+    size_t grown = capacity == 0 ? 1 : 2 * capacity;
+    keys.resize(grown);
+    motions.resize(grown);
+    std::vector<uint32_t> moved(2 * grown, EMPTY);
+    for (size_t slot = 0; slot < capacity; ++slot) {
+        moved[grown + slot] = winners[capacity + slot];
+    }
+    winners = std::move(moved);
+    for (size_t slot = grown; slot-- > capacity;) {
+        freeSlots.push_back(static_cast<uint32_t>(slot));
+    }
+    capacity = grown;
+    rebuild();
+}
+
+void KineticTournament::handleCertificateFailure(size_t node) {
+    // The loser has just caught up: it takes the match, and the change
+    // carries up as far as it wins
+    uint32_t a = winners[2 * node];
+    uint32_t b = winners[2 * node + 1];
+    winners[node] = winners[node] == a ? b : a;
+    certify(node);
+    replay(node / 2, false);
+}
+
+} // namespace kinetic
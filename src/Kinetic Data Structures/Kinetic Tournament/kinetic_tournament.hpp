@@ -0,0 +1,80 @@
+#ifndef KINETIC_TOURNAMENT_HPP
+#define KINETIC_TOURNAMENT_HPP
+
+#include "../event_queue.hpp"
+#include "../trajectory.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace kinetic {
+
+// Kinetic Tournament class: tracks the maximum of a set of moving
+// priorities. Elements sit in the leaves of a complete binary tree stored
+// flat as an array (node i has children 2i and 2i+1, leaves start at the
+// capacity), and each internal node holds the winner of its two children.
+// Every internal node carries one certificate, keyed by the time its losing
+// child overtakes the winner; a failure hands the win over and replays the
+// matches up the path, re-keying O(log n) certificates, so an event costs
+// O(log^2 n). Keys name elements and must be distinct.
+class KineticTournament {
+public:
+    KineticTournament() = default;
+
+    // Replaces the contents in O(n). Throws std::invalid_argument unless
+    // there is one priority per key and the keys are distinct.
+    void buildTournament(const std::vector<int>& keys, const std::vector<Trajectory>& priorities);
+    // Throws std::invalid_argument if key is already present.
+    void insert(int key, const Trajectory& priority);
+    void remove(int key);
+    // Gives a present key a new trajectory from now on.
+    void setPriority(int key, const Trajectory& priority);
+    bool contains(int key) const { return slotOf.count(key) != 0; }
+    bool isEmpty() const { return slotOf.empty(); }
+    size_t size() const { return slotOf.size(); }
+    size_t certificateCount() const { return eventQueue.size(); }
+
+    // Key and priority of the current maximum in O(1). Throw
+    // std::out_of_range if the tournament is empty.
+    int currentMax() const;
+    double currentMaxPriority() const;
+
+    // Moves the clock forward to t, replaying the matches at every
+    // certificate failure on the way in time order. Throws
+    // std::invalid_argument if t is in the past.
+    void advance(double t);
+    double now() const { return currentTime; }
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    // Per slot; a slot is the leaf capacity + slot
+    std::vector<int> keys;
+    std::vector<Trajectory> motions;
+    std::vector<uint32_t> freeSlots;
+    // Winning slot of every tree node, EMPTY for an empty subtree; index 0
+    // is unused and 1 is the root
+    std::vector<uint32_t> winners;
+    size_t capacity = 0;
+    std::unordered_map<int, uint32_t> slotOf;
+    EventQueue<Certificate> eventQueue;  // Ids are internal node indices
+    double currentTime = 0;
+
+    double valueOf(uint32_t slot) const { return motions[slot].at(currentTime); }
+    uint32_t playMatch(size_t node) const;
+    // Re-keys the certificate of an internal node from its current winner.
+    void certify(size_t node);
+    // Replays the matches from node up; stops once a winner is unchanged
+    // unless toRoot is set (needed when the winner's own trajectory moved).
+    void replay(size_t node, bool toRoot);
+    // Rebuilds every winner and certificate bottom-up in O(n).
+    void rebuild();
+    void grow();
+    void handleCertificateFailure(size_t node);
+};
+
+} // namespace kinetic
+
+#endif // KINETIC_TOURNAMENT_HPP
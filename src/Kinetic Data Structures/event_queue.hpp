@@ -0,0 +1,174 @@
+#ifndef KINETIC_EVENT_QUEUE_HPP
+#define KINETIC_EVENT_QUEUE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace kinetic {
+
+// Certificate guarding the edge from a node to its parent: the parent's
+// priority is at least the child's. It fails at the moment the child's
+// trajectory overtakes the parent's, so the queue keeps the earliest
+// failure on top.
+struct Certificate {
+    int key;             // The child's key
+    double failureTime;  // NEVER if the order cannot change
+    bool operator<(const Certificate &other) const {
+        return failureTime < other.failureTime;
+    }
+};
+
+// Instrumentation snapshot of a kinetic structure counted with
+// stats::Count.
+struct KineticStats {
+    uint64_t rotations = 0;                // Rotations (heater) or element swaps (hanger)
+    uint64_t certificatesPushed = 0;       // Certificates scheduled or re-keyed
+    uint64_t certificatesInvalidated = 0;  // Certificates dropped from the queue
+    uint64_t events = 0;                   // Certificate failures processed
+};
+
+// Addressable min-heap of certificates for the kinetic structures. Every
+// entry is named by a small integer id chosen by the caller (a node handle),
+// so a certificate can be re-keyed or dropped in O(log n) when the edge it
+// guards changes, instead of rebuilding the queue. A 4-ary layout keeps
+// sift-down within a cache line of children.
+template<typename Key, typename Compare = std::less<Key>>
+class EventQueue {
+public:
+    using Id = uint32_t;
+
+    EventQueue() = default;
+    explicit EventQueue(Compare compare) : compare(std::move(compare)) {}
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    bool contains(Id id) const { return id < position.size() && position[id] != NONE; }
+
+    // Inserts the certificate for id, or re-keys it if present (both
+    // decrease- and increase-key).
+    void push(Id id, const Key& key) {
+        if (contains(id)) {
+            size_t i = position[id];
+            bool up = compare(key, heap[i].first);
+            heap[i].first = key;
+            if (up) {
+                siftUp(i);
+            } else {
+                siftDown(i);
+            }
+            return;
+        }
+        if (id >= position.size()) position.resize(id + 1, NONE);
+        heap.emplace_back(key, id);
+        position[id] = static_cast<uint32_t>(heap.size() - 1);
+        siftUp(heap.size() - 1);
+    }
+
+    // Drops the certificate for id; no-op if there is none.
+    void erase(Id id) {
+        if (!contains(id)) return;
+        size_t i = position[id];
+        position[id] = NONE;
+        if (i + 1 == heap.size()) {
+            heap.pop_back();
+            return;
+        }
+        heap[i] = std::move(heap.back());
+        heap.pop_back();
+        position[heap[i].second] = static_cast<uint32_t>(i);
+        siftUp(i);
+        siftDown(position[heap[i].second]);
+    }
+
+    const Key& key(Id id) const {
+        if (!contains(id)) throw std::out_of_range("EventQueue::key: no certificate for id");
+        return heap[position[id]].first;
+    }
+
+    // Id and key of the earliest certificate; the queue must not be empty.
+    Id top() const { return heap.front().second; }
+    const Key& topKey() const { return heap.front().first; }
+    void pop() { erase(top()); }
+
+    void clear() {
+        heap.clear();
+        position.clear();
+    }
+
+    // Replaces the contents with entries (ids must be distinct) in O(n).
+    void build(std::vector<std::pair<Key, Id>> entries) {
+        heap = std::move(entries);
+        position.clear();
+        for (size_t i = 0; i < heap.size(); ++i) {
+            Id id = heap[i].second;
+            if (id >= position.size()) position.resize(id + 1, NONE);
+            position[id] = static_cast<uint32_t>(i);
+        }
+        for (size_t i = heap.size() / ARITY + 1; i-- > 0;) {
+            if (i < heap.size()) siftDown(i);
+        }
+    }
+
+private:
+    static constexpr size_t ARITY = 4;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    std::vector<std::pair<Key, Id>> heap;
+    std::vector<uint32_t> position;  // Indexed by id; NONE when absent
+    Compare compare;
+
+    void place(size_t i, std::pair<Key, Id>&& entry) {
+        position[entry.second] = static_cast<uint32_t>(i);
+        heap[i] = std::move(entry);
+    }
+
+    void siftUp(size_t i) {
+        std::pair<Key, Id> entry = std::move(heap[i]);
+        while (i > 0) {
+            size_t parent = (i - 1) / ARITY;
+            if (!compare(entry.first, heap[parent].first)) break;
+            place(i, std::move(heap[parent]));
+            i = parent;
+        }
+        place(i, std::move(entry));
+    }
+
+    void siftDown(size_t i) {
+        std::pair<Key, Id> entry = std::move(heap[i]);
+        for (;;) {
+            size_t first = i * ARITY + 1;
+            if (first >= heap.size()) break;
+            size_t last = std::min(first + ARITY, heap.size());
+            size_t best = first;
+            for (size_t c = first + 1; c < last; ++c) {
+                if (compare(heap[c].first, heap[best].first)) best = c;
+            }
+            if (!compare(heap[best].first, entry.first)) break;
+            place(i, std::move(heap[best]));
+            i = best;
+        }
+        place(i, std::move(entry));
+    }
+};
+
+// The kinetic simulation loop shared by every structure: moves the clock
+// to each certificate failure up to t in time order and hands the failing
+// id to repair, which must re-key or drop that certificate. Leaves the clock
+// at t. The caller checks that t is not in the past.
+template<typename Repair>
+void processEvents(EventQueue<Certificate>& queue, double& now, double t, Repair repair) {
+    while (!queue.empty() && queue.topKey().failureTime <= t) {
+        now = std::max(now, queue.topKey().failureTime);
+        repair(queue.top());
+    }
+    now = t;
+}
+
+} // namespace kinetic
+
+#endif // KINETIC_EVENT_QUEUE_HPP
@@ -0,0 +1,145 @@
+#ifndef KINETIC_NODE_POOL_HPP
+#define KINETIC_NODE_POOL_HPP
+
+#include "event_queue.hpp"
+#include "trajectory.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace kinetic {
+
+// Nodes are named by 32-bit handles into a NodePool; NIL marks a missing
+// child or parent. A handle also names the node's certificate in the
+// EventQueue.
+using Handle = uint32_t;
+constexpr Handle NIL = UINT32_MAX;
+
+// Pooled tree nodes stored as a struct of arrays: 40 bytes per node, no
+// per-node allocation, and the fields a traversal reads (keys, children)
+// packed densely. Released handles are reused, chained through left.
+class NodePool {
+public:
+    Handle allocate(int key, const Trajectory& priority) {
+        Handle h;
+        if (freeHead != NIL) {
+            h = freeHead;
+            freeHead = lefts[h];
+            keys[h] = key;
+            motions[h] = priority;
+        } else {
+            h = static_cast<Handle>(keys.size());
+            keys.push_back(key);
+            motions.push_back(priority);
+            lefts.push_back(NIL);
+            rights.push_back(NIL);
+            parents.push_back(NIL);
+        }
+        lefts[h] = rights[h] = parents[h] = NIL;
+        ++live;
+        return h;
+    }
+
+    void release(Handle h) {
+        lefts[h] = freeHead;
+        freeHead = h;
+        --live;
+    }
+
+    void clear() {
+        keys.clear();
+        motions.clear();
+        lefts.clear();
+        rights.clear();
+        parents.clear();
+        freeHead = NIL;
+        live = 0;
+    }
+
+    void reserve(size_t n) {
+        keys.reserve(n);
+        motions.reserve(n);
+        lefts.reserve(n);
+        rights.reserve(n);
+        parents.reserve(n);
+    }
+
+    // Links the nodes of order, taken as the in-order sequence, into a
+    // Cartesian tree on their priorities at time t with one stack pass.
+    // Returns the root; its parent is left as NIL.
+    Handle linkCartesian(const std::vector<Handle>& order, double t) {
+        std::vector<Handle> stack;
+        for (Handle h : order) {
+            double value = motions[h].at(t);
+            Handle last = NIL;
+            while (!stack.empty() && value > motions[stack.back()].at(t)) {
+                last = stack.back();
+                stack.pop_back();
+            }
+            if (last != NIL) {
+                lefts[h] = last;
+                parents[last] = h;
+            }
+            if (!stack.empty()) {
+                rights[stack.back()] = h;
+                parents[h] = stack.back();
+            }
+            stack.push_back(h);
+        }
+        return stack.empty() ? NIL : stack.front();
+    }
+
+    // Certificates for every edge below root at time t, ready for
+    // EventQueue::build.
+    std::vector<std::pair<Certificate, Handle>> certificates(Handle root, double t) const {
+        std::vector<std::pair<Certificate, Handle>> entries;
+        if (root == NIL) return entries;
+        entries.reserve(live);
+        std::vector<Handle> stack{root};
+        while (!stack.empty()) {
+            Handle current = stack.back();
+            stack.pop_back();
+            for (Handle child : {lefts[current], rights[current]}) {
+                if (child == NIL) continue;
+                entries.push_back({{keys[child], failureTime(motions[current], motions[child], t)}, child});
+                stack.push_back(child);
+            }
+        }
+        return entries;
+    }
+
+    int& key(Handle h) { return keys[h]; }
+    int key(Handle h) const { return keys[h]; }
+    Trajectory& priority(Handle h) { return motions[h]; }
+    const Trajectory& priority(Handle h) const { return motions[h]; }
+    Handle& left(Handle h) { return lefts[h]; }
+    Handle left(Handle h) const { return lefts[h]; }
+    Handle& right(Handle h) { return rights[h]; }
+    Handle right(Handle h) const { return rights[h]; }
+    Handle& parent(Handle h) { return parents[h]; }
+    Handle parent(Handle h) const { return parents[h]; }
+
+    // Live nodes
+    size_t size() const { return live; }
+    // One past the largest handle ever allocated
+    size_t capacity() const { return keys.size(); }
+    size_t memoryUsage() const {
+        return keys.capacity() * sizeof(int) + motions.capacity() * sizeof(Trajectory) +
+               (lefts.capacity() + rights.capacity() + parents.capacity()) * sizeof(Handle);
+    }
+
+private:
+    std::vector<int> keys;
+    std::vector<Trajectory> motions;
+    std::vector<Handle> lefts;
+    std::vector<Handle> rights;
+    std::vector<Handle> parents;
+    Handle freeHead = NIL;
+    size_t live = 0;
+};
+
+} // namespace kinetic
+
+#endif // KINETIC_NODE_POOL_HPP
@@ -0,0 +1,59 @@
+#ifndef KINETIC_TRAJECTORY_HPP
+#define KINETIC_TRAJECTORY_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace kinetic {
+
+constexpr double NEVER = std::numeric_limits<double>::infinity();
+
+// Priority of a moving element as a polynomial of time,
+// c0 + c1 t + c2 t^2. Constant and linear motion are the common cases;
+// the quadratic term covers constant acceleration.
+struct Trajectory {
+    double c0 = 0;
+    double c1 = 0;
+    double c2 = 0;
+
+    static Trajectory constant(double value) { return {value, 0, 0}; }
+    static Trajectory linear(double start, double rate) { return {start, rate, 0}; }
+
+    double at(double t) const { return c0 + t * (c1 + t * c2); }
+};
+
+// Earliest time >= now at which lower overtakes upper, or NEVER. Only a root
+// where upper - lower crosses downward counts, so once a certificate has
+// been repaired at a root its reversed replacement does not fire on that
+// same root again.
+inline double failureTime(const Trajectory& upper, const Trajectory& lower, double now) {
+    const double a = upper.c0 - lower.c0;
+    const double b = upper.c1 - lower.c1;
+    const double c = upper.c2 - lower.c2;
+    if (c == 0) {
+        if (b >= 0) return NEVER;
+        return std::max(now, -a / b);
+    }
+    const double disc = b * b - 4 * a * c;
+    if (disc <= 0) {
+        // Never changes sign: always ahead, or (c < 0) never ahead
+        return c > 0 ? NEVER : now;
+    }
+    // Numerically stable pair of roots
+    const double q = -0.5 * (b + std::copysign(std::sqrt(disc), b));
+    double lo = q / c;
+    double hi = a / q;
+    if (lo > hi) std::swap(lo, hi);
+    if (c > 0) {
+        // Negative between the roots
+        if (lo >= now) return lo;
+        return hi > now ? now : NEVER;
+    }
+    // Negative outside the roots
+    return std::max(now, hi);
+}
+
+} // namespace kinetic
+
+#endif // KINETIC_TRAJECTORY_HPP
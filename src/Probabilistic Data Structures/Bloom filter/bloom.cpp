@@ -1,10 +1,79 @@
-#ifndef BLOOM_H
-#define BLOOM_H
+#include "bloom.h"
 
 #include <algorithm>
-#include <assert.h>
-#include <sstream>
-#include <climits>
+#include <cmath>
+#include <stdexcept>
 
-using namespace std;
+namespace bloom {
 
+BloomFilter::BloomFilter(size_t expected_keys, double bits_per_key, uint64_t seed)
+    : seed(seed) {
+    if (!(bits_per_key > 0.0)) {
+        throw std::invalid_argument("Bloom filter needs a positive number of bits per key");
+    }
+    double bits = std::ceil(static_cast<double>(expected_keys) * bits_per_key);
+    size_t count = static_cast<size_t>(bits / (8.0 * sizeof(Block))) + 1;
+    blocks = snapshot::Array<Block>(count);
+}
+
+BloomFilter::BloomFilter(snapshot::Reader& reader)
+    : seed(reader.field(0)) {
+    size_t count = reader.field(1);
+    if (count == 0) reader.fail("Bloom filter without blocks");
+    blocks = reader.take<Block>(count);
+}
+
+void BloomFilter::insert_batch(const uint64_t* keys, size_t n) {
+    uint64_t hashes[BATCH_WINDOW];
+    size_t index[BATCH_WINDOW];
+    for (size_t base = 0; base < n; base += BATCH_WINDOW) {
+        size_t len = std::min(BATCH_WINDOW, n - base);
+        for (size_t i = 0; i < len; ++i) {
+            hashes[i] = hash(keys[base + i]);
+            index[i] = block_index(hashes[i]);
+            __builtin_prefetch(&blocks[index[i]], 1);
+        }
+        for (size_t i = 0; i < len; ++i) {
+            set_bits(blocks[index[i]], hashes[i]);
+        }
+    }
+}
+
+void BloomFilter::contains_batch(const uint64_t* keys, size_t n, uint8_t* out) const {
+    uint64_t hashes[BATCH_WINDOW];
+    size_t index[BATCH_WINDOW];
+    for (size_t base = 0; base < n; base += BATCH_WINDOW) {
+        size_t len = std::min(BATCH_WINDOW, n - base);
+        for (size_t i = 0; i < len; ++i) {
+            hashes[i] = hash(keys[base + i]);
+            index[i] = block_index(hashes[i]);
+            __builtin_prefetch(&blocks[index[i]], 0);
+        }
+        for (size_t i = 0; i < len; ++i) {
+            out[base + i] = test_bits(blocks[index[i]], hashes[i]);
+        }
+    }
+}
+
+double BloomFilter::fill_ratio() const {
+    size_t set = 0;
+    for (const Block& block : blocks) {
+        for (uint32_t word : block.words) {
+            set += static_cast<size_t>(__builtin_popcount(word));
+        }
+    }
+    return static_cast<double>(set) / (blocks.size() * 8.0 * sizeof(Block));
+}
+
+void BloomFilter::save(const std::string& path) const {
+    snapshot::Writer out(path, snapshot::Kind::BLOOM, sizeof(Block), {seed, blocks.size()});
+    out.section(blocks.data(), size_in_bytes());
+    out.commit();
+}
+
+std::unique_ptr<BloomFilter> BloomFilter::load(const std::string& path) {
+    snapshot::Reader reader(path, snapshot::Kind::BLOOM, sizeof(Block));
+    return std::unique_ptr<BloomFilter>(new BloomFilter(reader));
+}
+
+} // namespace bloom
@@ -0,0 +1,138 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include "../snapshot.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace bloom {
+
+// Blocked Bloom filter over 64-bit keys. Every key maps to one 32-byte block
+// (8 x 32-bit words, always inside a single 64-byte cache line) and sets one
+// bit in each word, so a lookup costs one cache miss. The block comes from
+// the high bits of a 64-bit hash; the eight bit positions come from
+// h1 + i * h2 (double hashing) on a remix of the same hash. With AVX2 the
+// eight bits are built, set and tested with a single vector operation each.
+//
+// At 10 bits per key the false positive rate is about 1.5%; 16 bits per key
+// gives about 0.3%.
+class BloomFilter {
+public:
+    explicit BloomFilter(size_t expected_keys, double bits_per_key = 10.0,
+                         uint64_t seed = 0x5bd1e9955bd1e995ULL);
+
+    void insert(uint64_t key);
+    [[nodiscard]] bool contains(uint64_t key) const;
+
+    // Bulk forms of insert/contains. Keys are handled in windows of
+    // BATCH_WINDOW: the whole window is hashed and its blocks prefetched
+    // before any of them is probed, so the cache misses overlap instead of
+    // being paid one after another. out[i] is set to 1 or 0.
+    void insert_batch(const uint64_t* keys, size_t n);
+    void contains_batch(const uint64_t* keys, size_t n, uint8_t* out) const;
+
+    static constexpr size_t BATCH_WINDOW = 32;
+
+    [[nodiscard]] size_t num_blocks() const { return blocks.size(); }
+    [[nodiscard]] size_t size_in_bytes() const { return blocks.size() * sizeof(Block); }
+    [[nodiscard]] uint64_t get_seed() const { return seed; }
+    // Fraction of bits set, which sets the false positive rate; O(size).
+    [[nodiscard]] double fill_ratio() const;
+
+    // Snapshots of the raw block array (see snapshot.h). A loaded filter
+    // queries the mapped file in place and copies pages as inserts touch
+    // them. save() must not run concurrently with insert().
+    void save(const std::string& path) const;
+    [[nodiscard]] static std::unique_ptr<BloomFilter> load(const std::string& path);
+
+private:
+    struct alignas(32) Block {
+        uint32_t words[8];
+    };
+
+    static constexpr int SHIFT = 27;  // Keeps the top 5 bits: a bit within a word
+
+    explicit BloomFilter(snapshot::Reader& reader);
+
+    [[nodiscard]] uint64_t hash(uint64_t key) const;
+    [[nodiscard]] size_t block_index(uint64_t h) const;
+    static void set_bits(Block& block, uint64_t h);
+    [[nodiscard]] static bool test_bits(const Block& block, uint64_t h);
+
+    snapshot::Array<Block> blocks;
+    uint64_t seed;
+};
+
+inline uint64_t BloomFilter::hash(uint64_t key) const {
+    // murmur3 fmix64
+    uint64_t h = key ^ seed;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline size_t BloomFilter::block_index(uint64_t h) const {
+    // Multiply-shift range reduction instead of a modulo.
+    return static_cast<size_t>((static_cast<unsigned __int128>(h) * blocks.size()) >> 64);
+}
+
+inline void BloomFilter::set_bits(Block& block, uint64_t h) {
+    uint64_t g = h * 0x9e3779b97f4a7c15ULL;
+    uint32_t h1 = static_cast<uint32_t>(g);
+    uint32_t h2 = static_cast<uint32_t>(g >> 32) | 1;
+#if defined(__AVX2__)
+    __m256i probe = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(h1)),
+                                     _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(h2)),
+                                                        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_srli_epi32(probe, SHIFT));
+    __m256i* p = reinterpret_cast<__m256i*>(block.words);
+    _mm256_store_si256(p, _mm256_or_si256(_mm256_load_si256(p), mask));
+#else
+    for (uint32_t i = 0; i < 8; ++i) {
+        block.words[i] |= uint32_t(1) << ((h1 + i * h2) >> SHIFT);
+    }
+#endif
+}
+
+inline bool BloomFilter::test_bits(const Block& block, uint64_t h) {
+    uint64_t g = h * 0x9e3779b97f4a7c15ULL;
+    uint32_t h1 = static_cast<uint32_t>(g);
+    uint32_t h2 = static_cast<uint32_t>(g >> 32) | 1;
+#if defined(__AVX2__)
+    __m256i probe = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(h1)),
+                                     _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(h2)),
+                                                        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_srli_epi32(probe, SHIFT));
+    // testc is set when every bit of mask is also set in the block.
+    return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(block.words)), mask);
+#else
+    for (uint32_t i = 0; i < 8; ++i) {
+        if ((block.words[i] & (uint32_t(1) << ((h1 + i * h2) >> SHIFT))) == 0) return false;
+    }
+    return true;
+#endif
+}
+
+inline void BloomFilter::insert(uint64_t key) {
+    uint64_t h = hash(key);
+    set_bits(blocks[block_index(h)], h);
+}
+
+inline bool BloomFilter::contains(uint64_t key) const {
+    uint64_t h = hash(key);
+    return test_bits(blocks[block_index(h)], h);
+}
+
+} // namespace bloom
+
+#endif // BLOOM_H
@@ -1,5 +1,506 @@
 #ifndef CUCKOO_H
 #define CUCKOO_H
 
+#include "../../stats.hpp"
+#include "../snapshot.h"
+
 #include <assert.h>
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace cuckoo {
+
+// Instrumentation snapshot of a CuckooFilter counted with stats::Count.
+struct CuckooStats {
+    uint64_t inserts = 0;         // Insert calls, including ones that failed
+    uint64_t failed_inserts = 0;  // Rejected because the filter was full
+    uint64_t kicks = 0;           // Fingerprints moved to make room
+    double load_factor = 0;       // At the time of the snapshot
+
+    [[nodiscard]] double kicks_per_insert() const {
+        return inserts == 0 ? 0.0 : static_cast<double>(kicks) / inserts;
+    }
+};
+
+// Cuckoo filter over 64-bit keys with deletion. The table has a power of two
+// number of buckets, each holding four FingerprintBits-wide fingerprints;
+// the four slots are packed back to back into a 4 * FingerprintBits bit wide
+// bucket word, so 12-bit fingerprints cost 12 bits per slot. A fingerprint
+// of 0 marks an empty slot.
+//
+// A key lives in one of two buckets, i1 = hash(key) and
+// i2 = i1 ^ hash(fingerprint) (partial-key cuckoo hashing), so either bucket
+// can be found again from the other plus the fingerprint when relocating.
+// When both are full, insert searches breadth first for an eviction path of
+// at most MAX_PATH_LENGTH moves ending in a free slot and applies it from the
+// far end, so every fingerprint stays visible while it moves. If there is
+// no such path the new fingerprint is kept in a one-entry victim stash and
+// the filter reports itself full.
+//
+// contains() is lock-free and may run on any number of threads while a
+// single writer inserts or removes; writers must be serialized by the
+// caller. Buckets map onto a table of version stripes: the writer makes a
+// stripe's version odd while it changes any bucket in it, and a reader
+// retries if either of its two stripes changed while it loaded the buckets.
+// Both buckets are then compared against the fingerprint with SWAR
+// arithmetic, at most two cache lines per query.
+//
+// False positive rate is about 8 / 2^FingerprintBits: 3% for 8 bits, 0.2%
+// for 12 and 0.01% for 16, at roughly FingerprintBits / 0.95 bits per key
+// when filled to the usual 95% load.
+//
+// Stats is stats::None or stats::Count (see stats.hpp); counting happens
+// on the writer side only, so contains() stays lock-free and unchanged.
+template<unsigned FingerprintBits = 12, class Stats = stats::None>
+class CuckooFilter {
+    static_assert(FingerprintBits == 8 || FingerprintBits == 12 || FingerprintBits == 16,
+                  "fingerprints must be 8, 12 or 16 bits wide");
+
+public:
+    static constexpr size_t SLOTS_PER_BUCKET = 4;
+    static constexpr unsigned BUCKET_BITS = SLOTS_PER_BUCKET * FingerprintBits;
+    static constexpr size_t MAX_PATH_LENGTH = 5;
+    static constexpr size_t MAX_VERSION_STRIPES = 4096;
+
+    explicit CuckooFilter(size_t capacity, uint64_t seed = 0x2545f4914f6cdd1dULL);
+    // no copying!!!
+    CuckooFilter(const CuckooFilter&) = delete;
+    CuckooFilter& operator=(const CuckooFilter&) = delete;
+
+    // Returns false when the key could not be placed; the filter is then
+    // full and further inserts fail until something is removed.
+    [[nodiscard]] bool insert(uint64_t key);
+    [[nodiscard]] bool contains(uint64_t key) const;
+    // Removes one copy of key's fingerprint. Removing a key that was never
+    // inserted may remove a colliding key instead, as in any cuckoo filter.
+    [[nodiscard]] bool remove(uint64_t key);
+
+    [[nodiscard]] size_t size() const { return count.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool empty() const { return size() == 0; }
+    [[nodiscard]] size_t num_buckets() const { return bucket_count; }
+    [[nodiscard]] double load_factor() const {
+        return static_cast<double>(size()) / (bucket_count * SLOTS_PER_BUCKET);
+    }
+    [[nodiscard]] size_t size_in_bytes() const {
+        return word_count * sizeof(uint64_t) + (stripe_mask + 1) * sizeof(uint32_t);
+    }
+    // Counters are all zero unless Stats is stats::Count.
+    [[nodiscard]] CuckooStats stats() const {
+        CuckooStats snapshot = counters.snapshot();
+        snapshot.load_factor = load_factor();
+        return snapshot;
+    }
+    void reset_stats() { counters.reset(); }
+
+    // Snapshots of the raw bucket array (see snapshot.h). A loaded filter
+    // queries the mapped file in place and copies pages as inserts and
+    // removes touch them; the counters start from zero. save() may run
+    // alongside contains() but not alongside a writer.
+    void save(const std::string& path) const;
+    [[nodiscard]] static std::unique_ptr<CuckooFilter> load(const std::string& path);
+
+private:
+    static constexpr uint64_t FP_MASK = (uint64_t(1) << FingerprintBits) - 1;
+    static constexpr uint64_t BUCKET_MASK =
+        BUCKET_BITS == 64 ? ~uint64_t(0) : (uint64_t(1) << BUCKET_BITS) - 1;
+    // Two 32-bit buckets of 8-bit fingerprints are probed as one 64-bit word.
+    static constexpr unsigned PROBE_LANES = BUCKET_BITS == 32 ? 8 : 4;
+    static constexpr uint64_t lane_ones() {
+        uint64_t ones = 0;
+        for (unsigned i = 0; i < PROBE_LANES; ++i) {
+            ones |= uint64_t(1) << (i * FingerprintBits);
+        }
+        return ones;
+    }
+    static constexpr uint64_t LANE_ONES = lane_ones();
+    static constexpr uint64_t LANE_HIGHS = LANE_ONES << (FingerprintBits - 1);
+    static constexpr uint32_t NO_PARENT = ~uint32_t(0);
+
+    // Victim stash packed into one word: used bit, fingerprint, bucket.
+    static constexpr uint64_t pack_victim(size_t index, uint32_t fingerprint) {
+        return (uint64_t(index) << 17) | (uint64_t(fingerprint) << 1) | 1;
+    }
+
+    struct PathNode {
+        size_t bucket;
+        uint32_t parent;  // Index into path_queue
+        uint8_t slot;     // Slot in the parent's bucket that moves here
+        uint8_t depth;
+    };
+
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) && std::atomic<uint64_t>::is_always_lock_free,
+                  "bucket words are mapped from snapshots as plain 64-bit words");
+
+    explicit CuckooFilter(snapshot::Reader& reader);
+    void init_versions();
+
+    [[nodiscard]] uint64_t hash(uint64_t key) const;
+    void locate(uint64_t key, size_t& index, uint32_t& fingerprint) const;
+    [[nodiscard]] size_t alt_index(size_t index, uint32_t fingerprint) const;
+
+    [[nodiscard]] uint64_t load_bucket(size_t i) const;
+    void store_bucket(size_t i, uint64_t bucket);
+    [[nodiscard]] static uint32_t slot(uint64_t bucket, size_t s) {
+        return static_cast<uint32_t>((bucket >> (s * FingerprintBits)) & FP_MASK);
+    }
+    [[nodiscard]] static uint64_t with_slot(uint64_t bucket, size_t s, uint32_t fingerprint) {
+        unsigned shift = s * FingerprintBits;
+        return (bucket & ~(FP_MASK << shift)) | (uint64_t(fingerprint) << shift);
+    }
+    [[nodiscard]] static int empty_slot(uint64_t bucket);
+    [[nodiscard]] static bool pair_contains(uint64_t b1, uint64_t b2, uint32_t fingerprint);
+    [[nodiscard]] static bool victim_matches(uint64_t v, size_t i1, size_t i2, uint32_t fingerprint);
+
+    [[nodiscard]] size_t stripe(size_t i) const { return i & stripe_mask; }
+    void begin_write(size_t a, size_t b);
+    void end_write(size_t a, size_t b);
+
+    [[nodiscard]] bool try_place(size_t i, uint32_t fingerprint);
+    [[nodiscard]] bool try_erase(size_t i, uint32_t fingerprint);
+    void move_slot(size_t from, size_t from_slot, size_t to, size_t to_slot);
+    [[nodiscard]] bool on_path(uint32_t node, size_t bucket) const;
+    [[nodiscard]] bool place(size_t index, uint32_t fingerprint);
+
+    // Buckets are packed as a bit stream; one extra word lets a bucket that
+    // straddles the last word boundary be read with two loads.
+    snapshot::Array<std::atomic<uint64_t>> words;
+    size_t word_count;
+    std::unique_ptr<std::atomic<uint32_t>[]> versions;
+    size_t stripe_mask;
+    size_t bucket_count;
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> victim{0};
+    uint64_t seed;
+    std::vector<PathNode> path_queue;  // Writer scratch for the BFS
+    stats::Counters<Stats, CuckooStats> counters;
+};
+
+template<unsigned FingerprintBits, class Stats>
+CuckooFilter<FingerprintBits, Stats>::CuckooFilter(size_t capacity, uint64_t seed)
+    : bucket_count(1)
+    , seed(seed) {
+    size_t wanted = std::max<size_t>(1, (capacity + SLOTS_PER_BUCKET - 1) / SLOTS_PER_BUCKET);
+    while (bucket_count < wanted) {
+        bucket_count <<= 1;
+    }
+    // Cuckoo tables rarely fill past ~95%; leave headroom for the request.
+    if (static_cast<double>(capacity) / (bucket_count * SLOTS_PER_BUCKET) > 0.96) {
+        bucket_count <<= 1;
+    }
+    if (bucket_count > (size_t(1) << 32)) {
+        throw std::length_error("cuckoo filter capacity exceeds 2^34 entries");
+    }
+    word_count = (bucket_count * BUCKET_BITS + 63) / 64 + 1;
+    words = snapshot::Array<std::atomic<uint64_t>>(word_count);
+    for (size_t w = 0; w < word_count; ++w) {
+        words[w].store(0, std::memory_order_relaxed);
+    }
+    init_versions();
+}
+
+template<unsigned FingerprintBits, class Stats>
+CuckooFilter<FingerprintBits, Stats>::CuckooFilter(snapshot::Reader& reader)
+    : bucket_count(reader.field(1))
+    , count(reader.field(2))
+    , victim(reader.field(3))
+    , seed(reader.field(0)) {
+    if (bucket_count == 0 || (bucket_count & (bucket_count - 1)) != 0 || bucket_count > (size_t(1) << 32)) {
+        reader.fail("cuckoo filter bucket count is not a power of two up to 2^32");
+    }
+    uint64_t stash = victim.load(std::memory_order_relaxed);
+    if ((stash & 1) && (stash >> 17) >= bucket_count) reader.fail("cuckoo filter victim outside the table");
+    word_count = (bucket_count * BUCKET_BITS + 63) / 64 + 1;
+    words = reader.take<std::atomic<uint64_t>>(word_count);
+    init_versions();
+}
+
+template<unsigned FingerprintBits, class Stats>
+void CuckooFilter<FingerprintBits, Stats>::init_versions() {
+    size_t stripes = std::min(bucket_count, MAX_VERSION_STRIPES);
+    stripe_mask = stripes - 1;
+    versions = std::make_unique<std::atomic<uint32_t>[]>(stripes);
+    for (size_t v = 0; v < stripes; ++v) {
+        versions[v].store(0, std::memory_order_relaxed);
+    }
+}
+
+template<unsigned FingerprintBits, class Stats>
+void CuckooFilter<FingerprintBits, Stats>::save(const std::string& path) const {
+    // The words are written as they are; a concurrent contains() only reads
+    snapshot::Writer out(path, snapshot::Kind::CUCKOO, FingerprintBits,
+                         {seed, bucket_count, size(), victim.load(std::memory_order_acquire)});
+    out.section(words.data(), word_count * sizeof(uint64_t));
+    out.commit();
+}
+
+template<unsigned FingerprintBits, class Stats>
+std::unique_ptr<CuckooFilter<FingerprintBits, Stats>> CuckooFilter<FingerprintBits, Stats>::load(const std::string& path) {
+    snapshot::Reader reader(path, snapshot::Kind::CUCKOO, FingerprintBits);
+    return std::unique_ptr<CuckooFilter>(new CuckooFilter(reader));
+}
+
+template<unsigned FingerprintBits, class Stats>
+uint64_t CuckooFilter<FingerprintBits, Stats>::hash(uint64_t key) const {
+    // murmur3 fmix64
+    uint64_t h = key ^ seed;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+template<unsigned FingerprintBits, class Stats>
+void CuckooFilter<FingerprintBits, Stats>::locate(uint64_t key, size_t& index, uint32_t& fingerprint) const {
+    uint64_t h = hash(key);
+    index = static_cast<size_t>(h >> 32) & (bucket_count - 1);
+    fingerprint = static_cast<uint32_t>(h & FP_MASK);
+    if (fingerprint == 0) {
+        fingerprint = 1;
+    }
+}
+
+template<unsigned FingerprintBits, class Stats>
+size_t CuckooFilter<FingerprintBits, Stats>::alt_index(size_t index, uint32_t fingerprint) const {
+    // An involution: alt_index(alt_index(i, f), f) == i.
+    return (index ^ (fingerprint * 0x5bd1e995u)) & (bucket_count - 1);
+}
+
+template<unsigned FingerprintBits, class Stats>
+uint64_t CuckooFilter<FingerprintBits, Stats>::load_bucket(size_t i) const {
+    size_t bit = i * BUCKET_BITS;
+    size_t w = bit / 64;
+    unsigned shift = bit % 64;
+    uint64_t bucket = words[w].load(std::memory_order_relaxed) >> shift;
+    if (shift + BUCKET_BITS > 64) {
+        bucket |= words[w + 1].load(std::memory_order_relaxed) << (64 - shift);
+    }
+    return bucket & BUCKET_MASK;
+}
+
+template<unsigned FingerprintBits, class Stats>
+void CuckooFilter<FingerprintBits, Stats>::store_bucket(size_t i, uint64_t bucket) {
+    // Only the writer stores, so the read-modify-write needs no CAS; each
+    // word store is atomic, which keeps neighbouring buckets intact for
+    // concurrent readers.
+    size_t bit = i * BUCKET_BITS;
+    size_t w = bit / 64;
+    unsigned shift = bit % 64;
+    uint64_t low = words[w].load(std::memory_order_relaxed);
+    words[w].store((low & ~(BUCKET_MASK << shift)) | (bucket << shift), std::memory_order_relaxed);
+    if (shift + BUCKET_BITS > 64) {
+        unsigned spill = shift + BUCKET_BITS - 64;
+        uint64_t high_mask = (uint64_t(1) << spill) - 1;
+        uint64_t high = words[w + 1].load(std::memory_order_relaxed);
+        words[w + 1].store((high & ~high_mask) | (bucket >> (64 - shift)), std::memory_order_relaxed);
+    }
+}
+
+template<unsigned FingerprintBits, class Stats>
+int CuckooFilter<FingerprintBits, Stats>::empty_slot(uint64_t bucket) {
+    for (size_t s = 0; s < SLOTS_PER_BUCKET; ++s) {
+        if (slot(bucket, s) == 0) return static_cast<int>(s);
+    }
+    return -1;
+}
+
+template<unsigned FingerprintBits, class Stats>
+bool CuckooFilter<FingerprintBits, Stats>::pair_contains(uint64_t b1, uint64_t b2, uint32_t fingerprint) {
+    // x has a zero lane iff (x - ones) & ~x & highs is nonzero; XOR with the
+    // broadcast fingerprint turns matching lanes into zero lanes.
+    uint64_t broadcast = fingerprint * LANE_ONES;
+    auto has_zero_lane = [](uint64_t x) { return ((x - LANE_ONES) & ~x & LANE_HIGHS) != 0; };
+    if constexpr (BUCKET_BITS == 32) {
+        return has_zero_lane((b1 | (b2 << 32)) ^ broadcast);
+    } else {
+        return has_zero_lane(b1 ^ broadcast) | has_zero_lane(b2 ^ broadcast);
+    }
+}
+
+template<unsigned FingerprintBits, class Stats>
+bool CuckooFilter<FingerprintBits, Stats>::victim_matches(uint64_t v, size_t i1, size_t i2, uint32_t fingerprint) {
+    if ((v & 1) == 0 || ((v >> 1) & 0xffff) != fingerprint) return false;
+    size_t index = static_cast<size_t>(v >> 17);
+    return index == i1 || index == i2;
+}
+
+template<unsigned FingerprintBits, class Stats>
+void CuckooFilter<FingerprintBits, Stats>::begin_write(size_t a, size_t b) {
+    versions[a].store(versions[a].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (b != a) {
+        versions[b].store(versions[b].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+template<unsigned FingerprintBits, class Stats>
+void CuckooFilter<FingerprintBits, Stats>::end_write(size_t a, size_t b) {
+    versions[a].store(versions[a].load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    if (b != a) {
+        versions[b].store(versions[b].load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+}
+
+template<unsigned FingerprintBits, class Stats>
+bool CuckooFilter<FingerprintBits, Stats>::try_place(size_t i, uint32_t fingerprint) {
+    uint64_t bucket = load_bucket(i);
+    int s = empty_slot(bucket);
+    if (s < 0) return false;
+    begin_write(stripe(i), stripe(i));
+    store_bucket(i, with_slot(bucket, s, fingerprint));
+    end_write(stripe(i), stripe(i));
+    return true;
+}
+
+template<unsigned FingerprintBits, class Stats>
+bool CuckooFilter<FingerprintBits, Stats>::try_erase(size_t i, uint32_t fingerprint) {
+    uint64_t bucket = load_bucket(i);
+    for (size_t s = 0; s < SLOTS_PER_BUCKET; ++s) {
+        if (slot(bucket, s) == fingerprint) {
+            begin_write(stripe(i), stripe(i));
+            store_bucket(i, with_slot(bucket, s, 0));
+            end_write(stripe(i), stripe(i));
+            return true;
+        }
+    }
+    return false;
+}
+
+template<unsigned FingerprintBits, class Stats>
+void CuckooFilter<FingerprintBits, Stats>::move_slot(size_t from, size_t from_slot, size_t to, size_t to_slot) {
+    // Both stripes are held so a reader never sees the fingerprint in neither
+    // of its buckets.
+    uint32_t fingerprint = slot(load_bucket(from), from_slot);
+    counters.update([](CuckooStats& s) { s.kicks++; });
+    begin_write(stripe(from), stripe(to));
+    store_bucket(to, with_slot(load_bucket(to), to_slot, fingerprint));
+    store_bucket(from, with_slot(load_bucket(from), from_slot, 0));
+    end_write(stripe(from), stripe(to));
+}
+
+template<unsigned FingerprintBits, class Stats>
+bool CuckooFilter<FingerprintBits, Stats>::on_path(uint32_t node, size_t bucket) const {
+    for (; node != NO_PARENT; node = path_queue[node].parent) {
+        if (path_queue[node].bucket == bucket) return true;
+    }
+    return false;
+}
+
+template<unsigned FingerprintBits, class Stats>
+bool CuckooFilter<FingerprintBits, Stats>::place(size_t index, uint32_t fingerprint) {
+    size_t other = alt_index(index, fingerprint);
+    if (try_place(index, fingerprint) || try_place(other, fingerprint)) return true;
+
+    // Breadth-first search for the shortest chain of moves that ends in a
+    // free slot. Nothing is modified until a path is found.
+    path_queue.clear();
+    path_queue.push_back({index, NO_PARENT, 0, 0});
+    path_queue.push_back({other, NO_PARENT, 0, 0});
+    for (uint32_t head = 0; head < path_queue.size(); ++head) {
+        PathNode node = path_queue[head];
+        if (node.depth >= MAX_PATH_LENGTH) break;
+        uint64_t bucket = load_bucket(node.bucket);
+        for (size_t s = 0; s < SLOTS_PER_BUCKET; ++s) {
+            size_t child = alt_index(node.bucket, slot(bucket, s));
+            if (on_path(head, child)) continue;
+            int free = empty_slot(load_bucket(child));
+            if (free < 0) {
+                path_queue.push_back({child, head, static_cast<uint8_t>(s),
+                                      static_cast<uint8_t>(node.depth + 1)});
+                continue;
+            }
+
+            // Apply the moves from the free slot back towards the root.
+            size_t to = child, to_slot = free, from_slot = s;
+            for (uint32_t cur = head;;) {
+                const PathNode& n = path_queue[cur];
+                move_slot(n.bucket, from_slot, to, to_slot);
+                to = n.bucket;
+                to_slot = from_slot;
+                if (n.parent == NO_PARENT) break;
+                from_slot = n.slot;
+                cur = n.parent;
+            }
+            begin_write(stripe(to), stripe(to));
+            store_bucket(to, with_slot(load_bucket(to), to_slot, fingerprint));
+            end_write(stripe(to), stripe(to));
+            return true;
+        }
+    }
+    return false;
+}
+
+template<unsigned FingerprintBits, class Stats>
+bool CuckooFilter<FingerprintBits, Stats>::insert(uint64_t key) {
+    counters.update([](CuckooStats& s) { s.inserts++; });
+    if (victim.load(std::memory_order_relaxed) & 1) {
+        counters.update([](CuckooStats& s) { s.failed_inserts++; });
+        return false;
+    }
+    size_t index;
+    uint32_t fingerprint;
+    locate(key, index, fingerprint);
+    if (!place(index, fingerprint)) {
+        victim.store(pack_victim(index, fingerprint), std::memory_order_release);
+    }
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return true;
+}
+
+template<unsigned FingerprintBits, class Stats>
+bool CuckooFilter<FingerprintBits, Stats>::contains(uint64_t key) const {
+    size_t i1;
+    uint32_t fingerprint;
+    locate(key, i1, fingerprint);
+    size_t i2 = alt_index(i1, fingerprint);
+    const std::atomic<uint32_t>& v1 = versions[stripe(i1)];
+    const std::atomic<uint32_t>& v2 = versions[stripe(i2)];
+    for (;;) {
+        uint32_t before1 = v1.load(std::memory_order_acquire);
+        uint32_t before2 = v2.load(std::memory_order_acquire);
+        if ((before1 | before2) & 1) continue;  // A write is in progress
+        uint64_t b1 = load_bucket(i1);
+        uint64_t b2 = load_bucket(i2);
+        uint64_t stash = victim.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (v1.load(std::memory_order_relaxed) == before1 && v2.load(std::memory_order_relaxed) == before2) {
+            return pair_contains(b1, b2, fingerprint) || victim_matches(stash, i1, i2, fingerprint);
+        }
+    }
+}
+
+template<unsigned FingerprintBits, class Stats>
+bool CuckooFilter<FingerprintBits, Stats>::remove(uint64_t key) {
+    size_t i1;
+    uint32_t fingerprint;
+    locate(key, i1, fingerprint);
+    size_t i2 = alt_index(i1, fingerprint);
+
+    if (try_erase(i1, fingerprint) || try_erase(i2, fingerprint)) {
+        count.store(count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        // A slot just opened up; give the stashed victim a chance to leave.
+        // It is placed before the stash is cleared so it never disappears.
+        uint64_t stash = victim.load(std::memory_order_relaxed);
+        if ((stash & 1) && place(static_cast<size_t>(stash >> 17), (stash >> 1) & 0xffff)) {
+            victim.store(0, std::memory_order_release);
+        }
+        return true;
+    }
+    if (victim_matches(victim.load(std::memory_order_relaxed), i1, i2, fingerprint)) {
+        victim.store(0, std::memory_order_release);
+        count.store(count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+} // namespace cuckoo
+
+#endif // CUCKOO_H
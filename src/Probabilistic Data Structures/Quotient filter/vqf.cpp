@@ -0,0 +1,90 @@
+#include "vqf.h"
+
+#include <algorithm>
+
+namespace vqf {
+
+VectorQuotientFilter::VectorQuotientFilter(size_t capacity, uint64_t seed)
+    : seed(seed) {
+    // Two-choice placement keeps blocks balanced up to about 93% full.
+    size_t block_count = static_cast<size_t>(static_cast<double>(capacity) / (SLOTS_PER_BLOCK * 0.93)) + 1;
+    Block empty{};
+    empty.md[0] = ~uint64_t(0);
+    empty.md[1] = (uint64_t(1) << (BUCKETS_PER_BLOCK - 64)) - 1;
+    blocks = snapshot::Array<Block>(block_count);
+    std::fill(blocks.begin(), blocks.end(), empty);
+}
+
+VectorQuotientFilter::VectorQuotientFilter(snapshot::Reader& reader)
+    : count(reader.field(2))
+    , seed(reader.field(0)) {
+    size_t block_count = reader.field(1);
+    if (block_count == 0) reader.fail("quotient filter without blocks");
+    blocks = reader.take<Block>(block_count);
+}
+
+void VectorQuotientFilter::save(const std::string& path) const {
+    snapshot::Writer out(path, snapshot::Kind::VECTOR_QUOTIENT, sizeof(Block), {seed, blocks.size(), count});
+    out.section(blocks.data(), size_in_bytes());
+    out.commit();
+}
+
+std::unique_ptr<VectorQuotientFilter> VectorQuotientFilter::load(const std::string& path) {
+    snapshot::Reader reader(path, snapshot::Kind::VECTOR_QUOTIENT, sizeof(Block));
+    return std::unique_ptr<VectorQuotientFilter>(new VectorQuotientFilter(reader));
+}
+
+bool VectorQuotientFilter::insert_into(Block& b, unsigned q, uint8_t tag) {
+    unsigned used = occupancy(b);
+    if (used == SLOTS_PER_BLOCK) return false;
+
+    // Open a 0 just before bucket q's terminator and the matching tag slot.
+    unsigned pos = select(b, q);
+    unsigned slot = pos - q;
+    std::memmove(b.tags + slot + 1, b.tags + slot, used - slot);
+    b.tags[slot] = tag;
+
+    Metadata md = load_md(b);
+    Metadata low = (Metadata(1) << pos) - 1;
+    store_md(b, (md & low) | ((md & ~low) << 1));
+    return true;
+}
+
+bool VectorQuotientFilter::remove_from(Block& b, unsigned q, uint8_t tag) {
+    uint64_t hits = match_tags(b, tag) & bucket_slots(b, q);
+    if (hits == 0) return false;
+
+    unsigned used = occupancy(b);
+    unsigned slot = static_cast<unsigned>(__builtin_ctzll(hits));
+    std::memmove(b.tags + slot, b.tags + slot + 1, used - slot - 1);
+    b.tags[used - 1] = 0;
+
+    // Drop the 0 that stood for this tag.
+    unsigned pos = slot + q;
+    Metadata md = load_md(b);
+    Metadata low = (Metadata(1) << pos) - 1;
+    store_md(b, (md & low) | ((md >> 1) & ~low));
+    return true;
+}
+
+bool VectorQuotientFilter::insert(uint64_t key) {
+    Location loc = locate(key);
+    Block& b1 = blocks[loc.block1];
+    Block& b2 = blocks[loc.block2];
+    Block& target = occupancy(b1) <= occupancy(b2) ? b1 : b2;
+    if (!insert_into(target, loc.bucket, loc.tag)) return false;
+    count++;
+    return true;
+}
+
+bool VectorQuotientFilter::remove(uint64_t key) {
+    Location loc = locate(key);
+    if (remove_from(blocks[loc.block1], loc.bucket, loc.tag) ||
+        remove_from(blocks[loc.block2], loc.bucket, loc.tag)) {
+        count--;
+        return true;
+    }
+    return false;
+}
+
+} // namespace vqf
@@ -0,0 +1,201 @@
+#ifndef VQF_H
+#define VQF_H
+
+#include "../snapshot.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#if defined(__AVX2__) || defined(__BMI2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace vqf {
+
+// Vector quotient filter (Pandey et al., "Vector Quotient Filters: Overcoming
+// the Time/Space Trade-Off in Filter Design") with 8-bit tags. The table is
+// an array of 64-byte blocks, each one cache line: 48 tag slots and a 128-bit
+// metadata word that spells out 80 buckets as unary run lengths (a 1 ends a
+// bucket, each 0 before it is one tag). A key hashes to a bucket number and
+// two candidate blocks and goes into the emptier one (power of two choices),
+// so lookups read at most two cache lines.
+//
+// Bucket boundaries are found with select on the metadata (pdep + tzcnt
+// with BMI2) and tags are compared 32 at a time with AVX2 (16 with SSE2).
+// The table fills to about 93% before inserts fail, at about 11.5 bits per
+// key and a false positive rate below 0.5%. Supports deletion.
+class VectorQuotientFilter {
+public:
+    static constexpr unsigned BUCKETS_PER_BLOCK = 80;
+    static constexpr unsigned SLOTS_PER_BLOCK = 48;
+
+    explicit VectorQuotientFilter(size_t capacity, uint64_t seed = 0x9ae16a3b2f90404fULL);
+
+    // Returns false if both candidate blocks are full.
+    [[nodiscard]] bool insert(uint64_t key);
+    [[nodiscard]] bool contains(uint64_t key) const;
+    [[nodiscard]] bool remove(uint64_t key);
+
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] bool empty() const { return count == 0; }
+    [[nodiscard]] size_t num_blocks() const { return blocks.size(); }
+    [[nodiscard]] double load_factor() const {
+        return static_cast<double>(count) / (blocks.size() * SLOTS_PER_BLOCK);
+    }
+    [[nodiscard]] size_t size_in_bytes() const { return blocks.size() * sizeof(Block); }
+
+    // Snapshots of the raw block array (see snapshot.h). A loaded filter
+    // queries the mapped file in place and copies pages as inserts and
+    // removes touch them.
+    void save(const std::string& path) const;
+    [[nodiscard]] static std::unique_ptr<VectorQuotientFilter> load(const std::string& path);
+
+private:
+    struct alignas(64) Block {
+        // Bit i of the 128-bit word md[1]:md[0]; starts as 80 ones (all
+        // buckets empty) followed by 48 zeros (free slots).
+        uint64_t md[2];
+        uint8_t tags[SLOTS_PER_BLOCK];
+    };
+    static_assert(sizeof(Block) == 64, "a block must fill exactly one cache line");
+
+    using Metadata = unsigned __int128;
+
+    struct Location {
+        size_t block1;
+        size_t block2;
+        unsigned bucket;
+        uint8_t tag;
+    };
+
+    explicit VectorQuotientFilter(snapshot::Reader& reader);
+
+    [[nodiscard]] Location locate(uint64_t key) const;
+
+    static Metadata load_md(const Block& b) { return (Metadata(b.md[1]) << 64) | b.md[0]; }
+    static void store_md(Block& b, Metadata md) {
+        b.md[0] = static_cast<uint64_t>(md);
+        b.md[1] = static_cast<uint64_t>(md >> 64);
+    }
+    static unsigned select64(uint64_t x, unsigned k);
+    // Position of the k-th (0-based) one in the metadata.
+    static unsigned select(const Block& b, unsigned k);
+    static unsigned occupancy(const Block& b) {
+        // The last bucket's terminating one is always in the high word.
+        return 64 + 63 - __builtin_clzll(b.md[1]) - (BUCKETS_PER_BLOCK - 1);
+    }
+    // Bit j is set when tags[j] == tag.
+    static uint64_t match_tags(const Block& b, uint8_t tag);
+    // Mask of the tag slots that belong to bucket q.
+    static uint64_t bucket_slots(const Block& b, unsigned q);
+
+    static bool insert_into(Block& b, unsigned q, uint8_t tag);
+    static bool remove_from(Block& b, unsigned q, uint8_t tag);
+
+    snapshot::Array<Block> blocks;
+    size_t count = 0;
+    uint64_t seed;
+};
+
+inline unsigned VectorQuotientFilter::select64(uint64_t x, unsigned k) {
+#if defined(__BMI2__)
+    return static_cast<unsigned>(_tzcnt_u64(_pdep_u64(uint64_t(1) << k, x)));
+#else
+    // Skip whole bytes first so at most 8 + 7 steps are needed.
+    unsigned base = 0;
+    for (unsigned c; k >= (c = __builtin_popcountll(x & 0xff)); k -= c) {
+        x >>= 8;
+        base += 8;
+    }
+    for (; k > 0; --k) {
+        x &= x - 1;
+    }
+    return base + static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+}
+
+inline unsigned VectorQuotientFilter::select(const Block& b, unsigned k) {
+    unsigned low = static_cast<unsigned>(__builtin_popcountll(b.md[0]));
+    return k < low ? select64(b.md[0], k) : 64 + select64(b.md[1], k - low);
+}
+
+inline uint64_t VectorQuotientFilter::match_tags(const Block& b, uint8_t tag) {
+#if defined(__AVX2__)
+    __m256i needle = _mm256_set1_epi8(static_cast<char>(tag));
+    // Slots 0-31 and 16-47; the overlap is harmless since both agree.
+    uint32_t low = _mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.tags)), needle));
+    uint32_t high = _mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.tags + 16)), needle));
+    return uint64_t(low) | (uint64_t(high) << 16);
+#elif defined(__SSE2__)
+    __m128i needle = _mm_set1_epi8(static_cast<char>(tag));
+    uint64_t mask = 0;
+    for (unsigned i = 0; i < SLOTS_PER_BLOCK; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b.tags + i));
+        mask |= uint64_t(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)))) << i;
+    }
+    return mask;
+#else
+    uint64_t mask = 0;
+    for (unsigned i = 0; i < SLOTS_PER_BLOCK; ++i) {
+        mask |= uint64_t(b.tags[i] == tag) << i;
+    }
+    return mask;
+#endif
+}
+
+inline uint64_t VectorQuotientFilter::bucket_slots(const Block& b, unsigned q) {
+    // Bucket q's tags sit between the terminators of buckets q - 1 and q;
+    // subtracting q converts metadata positions into tag slots.
+    unsigned start = q == 0 ? 0 : select(b, q - 1) + 1 - q;
+    unsigned end = select(b, q) - q;
+    return ((uint64_t(1) << end) - 1) & ~((uint64_t(1) << start) - 1);
+}
+
+inline VectorQuotientFilter::Location VectorQuotientFilter::locate(uint64_t key) const {
+    // murmur3 fmix64; the key hash gives tag, bucket and first block, a hash
+    // of (tag, bucket) the offset to the second.
+    auto mix = [](uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    };
+    auto range = [](uint64_t x, uint64_t n) {
+        return static_cast<size_t>((static_cast<unsigned __int128>(x) * n) >> 64);
+    };
+    const size_t n = blocks.size();
+    uint64_t h = mix(key ^ seed);
+    Location loc;
+    loc.tag = static_cast<uint8_t>(h);
+    loc.bucket = static_cast<unsigned>(((h >> 8) & 0xffffffffULL) * BUCKETS_PER_BLOCK >> 32);
+    loc.block1 = range(h, n);
+    // block2 = (offset - block1) mod n is an involution, so the pair of
+    // blocks depends only on either block plus (tag, bucket). Two entries
+    // with equal tag and bucket in one block then share both blocks, and
+    // remove() may take either without stranding the other.
+    size_t offset = range(mix((uint64_t(loc.bucket) << 8) | loc.tag), n);
+    loc.block2 = offset >= loc.block1 ? offset - loc.block1 : offset + n - loc.block1;
+    return loc;
+}
+
+inline bool VectorQuotientFilter::contains(uint64_t key) const {
+    Location loc = locate(key);
+    const Block& b1 = blocks[loc.block1];
+    const Block& b2 = blocks[loc.block2];
+    // Both blocks are always probed so their cache misses overlap.
+    return ((match_tags(b1, loc.tag) & bucket_slots(b1, loc.bucket)) |
+            (match_tags(b2, loc.tag) & bucket_slots(b2, loc.bucket))) != 0;
+}
+
+} // namespace vqf
+
+#endif // VQF_H
@@ -0,0 +1,267 @@
+#include "ConcurrentSkipList.hpp"
+
+#include <new>
+#include <random>
+
+template<typename T>
+size_t ConcurrentSkipList<T>::random_level() {
+    // Geometric with p = 1/2: one plus the trailing zeros of a random word.
+    thread_local std::mt19937_64 gen(std::random_device{}());
+    uint64_t bits = gen() | (uint64_t(1) << (MAX_LEVEL - 1));
+    return 1 + static_cast<size_t>(__builtin_ctzll(bits));
+}
+
+template<typename T>
+typename ConcurrentSkipList<T>::Node* ConcurrentSkipList<T>::allocate_node(size_t level) {
+    void* p = ::operator new(Node::bytes(level), std::align_val_t(alignof(Node)));
+    Node* node = reinterpret_cast<Node*>(p);
+    node->level = level;
+    new (&node->owners) std::atomic<int>(2);
+    for (size_t i = 0; i < level; i++) {
+        new (&node->next()[i]) std::atomic<uintptr_t>(0);
+    }
+    return node;
+}
+
+template<typename T>
+typename ConcurrentSkipList<T>::Node* ConcurrentSkipList<T>::create_node(const T& value, size_t level) {
+    Node* node = allocate_node(level);
+    try {
+        new (node->storage) T(value);
+    } catch (...) {
+        ::operator delete(node, std::align_val_t(alignof(Node)));
+        throw;
+    }
+    return node;
+}
+
+template<typename T>
+void ConcurrentSkipList<T>::free_node(void* p) {
+    Node* node = static_cast<Node*>(p);
+    node->value().~T();
+    ::operator delete(p, std::align_val_t(alignof(Node)));
+}
+
+template<typename T>
+ConcurrentSkipList<T>::ConcurrentSkipList()
+    : head(allocate_node(MAX_LEVEL))
+    , count(0) {}
+
+template<typename T>
+ConcurrentSkipList<T>::~ConcurrentSkipList() {
+    // Nodes still linked at level 0 are owned by the list; everything that
+    // was unlinked has already been retired.
+    Node* current = pointer(head->next()[0].load(std::memory_order_relaxed));
+    while (current) {
+        Node* next = pointer(current->next()[0].load(std::memory_order_relaxed));
+        free_node(current);
+        current = next;
+    }
+    ::operator delete(head, std::align_val_t(alignof(Node)));
+}
+
+template<typename T>
+bool ConcurrentSkipList<T>::find(const T& value, Node** preds, Node** succs) const {
+retry:
+    Node* pred = head;
+    for (int i = MAX_LEVEL - 1; i >= 0; i--) {
+        Node* current = pointer(pred->next()[i].load(std::memory_order_acquire));
+        while (current) {
+            uintptr_t succ = current->next()[i].load(std::memory_order_acquire);
+            while (is_marked(succ)) {
+                // Snip the deleted node; if pred changed under us, start over.
+                uintptr_t expected = link_to(current);
+                if (!pred->next()[i].compare_exchange_strong(expected, succ & ~uintptr_t(1),
+                                                             std::memory_order_acq_rel,
+                                                             std::memory_order_acquire)) {
+                    goto retry;
+                }
+                current = pointer(succ);
+                if (!current) break;
+                succ = current->next()[i].load(std::memory_order_acquire);
+            }
+            if (!current || !(current->value() < value)) break;
+            pred = current;
+            current = pointer(succ);
+        }
+        preds[i] = pred;
+        succs[i] = current;
+    }
+    return succs[0] && !(value < succs[0]->value());
+}
+
+template<typename T>
+typename ConcurrentSkipList<T>::Node* ConcurrentSkipList<T>::lower_bound(const T& value) const {
+    Node* pred = head;
+    Node* current = nullptr;
+    for (int i = MAX_LEVEL - 1; i >= 0; i--) {
+        current = pointer(pred->next()[i].load(std::memory_order_acquire));
+        while (current) {
+            uintptr_t succ = current->next()[i].load(std::memory_order_acquire);
+            if (is_marked(succ)) {
+                // Step over deleted nodes without helping; readers never write.
+                current = pointer(succ);
+            } else if (current->value() < value) {
+                pred = current;
+                current = pointer(succ);
+            } else {
+                break;
+            }
+        }
+    }
+    return current;
+}
+
+template<typename T>
+void ConcurrentSkipList<T>::release(Node* node) const {
+    if (node->owners.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    // Linking and deletion are both finished; one more search unlinks the
+    // node from any level it was attached to after the remover's search.
+    Node* preds[MAX_LEVEL];
+    Node* succs[MAX_LEVEL];
+    find(node->value(), preds, succs);
+    EpochManager::instance().retire(node, &free_node);
+}
+
+template<typename T>
+bool ConcurrentSkipList<T>::insert(const T& value) {
+    EpochGuard guard;
+    Node* preds[MAX_LEVEL];
+    Node* succs[MAX_LEVEL];
+    Node* node = nullptr;
+    size_t new_level = random_level();
+    for (;;) {
+        if (find(value, preds, succs)) {
+            if (node) free_node(node);
+            return false;
+        }
+        if (!node) node = create_node(value, new_level);
+        for (size_t i = 0; i < new_level; i++) {
+            node->next()[i].store(link_to(succs[i]), std::memory_order_relaxed);
+        }
+        // Linking level 0 is the linearization point.
+        uintptr_t expected = link_to(succs[0]);
+        if (preds[0]->next()[0].compare_exchange_strong(expected, link_to(node), std::memory_order_release,
+                                                        std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    count.fetch_add(1, std::memory_order_relaxed);
+
+    for (size_t i = 1; i < new_level; i++) {
+        for (;;) {
+            // Point the node at the current successor unless a remover has
+            // marked this level already, in which case stop building.
+            uintptr_t link = node->next()[i].load(std::memory_order_acquire);
+            if (is_marked(link)) goto done;
+            if (pointer(link) != succs[i] &&
+                !node->next()[i].compare_exchange_strong(link, link_to(succs[i]), std::memory_order_acq_rel)) {
+                goto done;
+            }
+            uintptr_t expected = link_to(succs[i]);
+            if (preds[i]->next()[i].compare_exchange_strong(expected, link_to(node), std::memory_order_release,
+                                                            std::memory_order_relaxed)) {
+                break;
+            }
+            if (!find(value, preds, succs) || succs[0] != node) goto done;
+        }
+    }
+done:
+    release(node);
+    return true;
+}
+
+template<typename T>
+bool ConcurrentSkipList<T>::remove(const T& value) {
+    EpochGuard guard;
+    Node* preds[MAX_LEVEL];
+    Node* succs[MAX_LEVEL];
+    if (!find(value, preds, succs)) {
+        return false;
+    }
+    Node* victim = succs[0];
+    for (size_t i = victim->level - 1; i >= 1; i--) {
+        victim->next()[i].fetch_or(1, std::memory_order_acq_rel);
+    }
+    // Only one remover can be the one to set the level 0 mark.
+    if (is_marked(victim->next()[0].fetch_or(1, std::memory_order_acq_rel))) {
+        return false;
+    }
+    count.fetch_sub(1, std::memory_order_relaxed);
+    find(value, preds, succs);
+    release(victim);
+    return true;
+}
+
+template<typename T>
+bool ConcurrentSkipList<T>::contains(const T& value) const {
+    EpochGuard guard;
+    Node* current = lower_bound(value);
+    return current && !(value < current->value());
+}
+
+template<typename T>
+bool ConcurrentSkipList<T>::empty() const {
+    return size() == 0;
+}
+
+template<typename T>
+size_t ConcurrentSkipList<T>::size() const {
+    ptrdiff_t n = count.load(std::memory_order_relaxed);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+template<typename T>
+std::optional<T> ConcurrentSkipList<T>::find_min() const {
+    EpochGuard guard;
+    uintptr_t link = head->next()[0].load(std::memory_order_acquire);
+    while (Node* current = pointer(link)) {
+        link = current->next()[0].load(std::memory_order_acquire);
+        if (!is_marked(link)) {
+            return current->value();
+        }
+    }
+    return std::nullopt;
+}
+
+template<typename T>
+std::optional<T> ConcurrentSkipList<T>::find_max() const {
+    EpochGuard guard;
+    for (;;) {
+        Node* pred = head;
+        for (int i = MAX_LEVEL - 1; i >= 0; i--) {
+            Node* current = pointer(pred->next()[i].load(std::memory_order_acquire));
+            while (current) {
+                uintptr_t succ = current->next()[i].load(std::memory_order_acquire);
+                if (!is_marked(succ)) {
+                    pred = current;
+                }
+                current = pointer(succ);
+            }
+        }
+        if (pred == head) {
+            return std::nullopt;
+        }
+        // pred may have been deleted after we passed it on a higher level.
+        if (!is_marked(pred->next()[0].load(std::memory_order_acquire))) {
+            return pred->value();
+        }
+    }
+}
+
+template<typename T>
+std::vector<T> ConcurrentSkipList<T>::range(const T& start, const T& end) const {
+    EpochGuard guard;
+    std::vector<T> result;
+    Node* current = lower_bound(start);
+    while (current && !(end < current->value())) {
+        uintptr_t link = current->next()[0].load(std::memory_order_acquire);
+        if (!is_marked(link)) {
+            result.push_back(current->value());
+        }
+        current = pointer(link);
+    }
+    return result;
+}
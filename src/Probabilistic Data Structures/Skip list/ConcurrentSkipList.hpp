@@ -0,0 +1,84 @@
+#ifndef CONCURRENT_SKIP_LIST_HPP
+#define CONCURRENT_SKIP_LIST_HPP
+
+#include "EpochReclamation.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Lock-free sorted set with the same interface as SkipList<T>, after the
+// lock-free skip list of Herlihy and Shavit (from Fraser's design). Every
+// level is a CAS-linked list; the low bit of a next pointer marks its node
+// as deleted at that level. remove() marks the tower top-down and the thread
+// whose mark lands on level 0 owns the deletion; any thread that meets a
+// marked node while searching snips it out. Unlinked nodes are handed to
+// the process-wide EpochManager, so readers never touch freed memory.
+//
+// insert() and remove() are lock-free, contains() is wait-free and performs
+// no stores to shared memory, so reads scale with the number of threads.
+// size() is exact once concurrent updates have finished, and while they
+// run it may lag behind but never wraps below zero; range(), find_min()
+// and find_max() see each value as it was at some point during the call.
+// Destruction must not race with any other operation.
+template<typename T>
+class ConcurrentSkipList {
+private:
+    // Node header followed by `level` atomic next pointers, allocated in one
+    // piece. The head's value is never constructed.
+    struct Node {
+        alignas(T) unsigned char storage[sizeof(T)];
+        size_t level;
+        // The inserter still linking upper levels and the set membership
+        // each hold one reference; whoever drops the last one retires it.
+        std::atomic<int> owners;
+
+        T& value() { return *reinterpret_cast<T*>(storage); }
+        std::atomic<uintptr_t>* next() { return reinterpret_cast<std::atomic<uintptr_t>*>(this + 1); }
+        static size_t bytes(size_t level) { return sizeof(Node) + level * sizeof(std::atomic<uintptr_t>); }
+    };
+    static_assert(sizeof(Node) % alignof(std::atomic<uintptr_t>) == 0, "tower must follow the header aligned");
+
+    static constexpr size_t MAX_LEVEL = 16;
+    Node* head;
+    // Signed: a remove can count a node before its insert has, which briefly
+    // takes the counter below the true size and past zero.
+    std::atomic<ptrdiff_t> count;
+
+    static Node* pointer(uintptr_t link) { return reinterpret_cast<Node*>(link & ~uintptr_t(1)); }
+    static bool is_marked(uintptr_t link) { return link & 1; }
+    static uintptr_t link_to(Node* node) { return reinterpret_cast<uintptr_t>(node); }
+
+    [[nodiscard]] static size_t random_level();
+    [[nodiscard]] static Node* allocate_node(size_t level);
+    [[nodiscard]] static Node* create_node(const T& value, size_t level);
+    static void free_node(void* p);
+    // Fills preds/succs with the neighbours of value on every level,
+    // unlinking marked nodes on the way; true if succs[0] holds value.
+    bool find(const T& value, Node** preds, Node** succs) const;
+    // First unmarked node at level 0 not less than value.
+    [[nodiscard]] Node* lower_bound(const T& value) const;
+    void release(Node* node) const;
+
+public:
+    ConcurrentSkipList();
+    ~ConcurrentSkipList();
+    // no copying or moving: other threads may hold the address
+    ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+    ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+    // Core
+    [[nodiscard]] bool insert(const T& value);
+    [[nodiscard]] bool remove(const T& value);
+    [[nodiscard]] bool contains(const T& value) const;
+    // Utility
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] std::optional<T> find_min() const;
+    [[nodiscard]] std::optional<T> find_max() const;
+    // Range operations
+    [[nodiscard]] std::vector<T> range(const T& start, const T& end) const;
+};
+
+#endif
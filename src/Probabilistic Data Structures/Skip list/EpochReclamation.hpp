@@ -0,0 +1,201 @@
+#ifndef EPOCH_RECLAMATION_HPP
+#define EPOCH_RECLAMATION_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// Process-wide epoch-based reclamation for lock-free structures.
+//
+// A thread pins the current global epoch for the duration of an operation
+// with an EpochGuard. Memory unlinked from a structure is retire()d instead
+// of freed; it is freed once the global epoch has advanced twice past the
+// epoch it was retired in, at which point no pinned thread can still hold a
+// reference to it. The epoch only advances when every pinned thread has
+// caught up with it, so a thread stalled inside a guard delays reclamation
+// (but never blocks other operations).
+class EpochManager {
+public:
+    static constexpr size_t MAX_THREADS = 256;
+    // Retirements between attempts to advance the epoch.
+    static constexpr size_t ADVANCE_INTERVAL = 64;
+
+    static EpochManager& instance() {
+        static EpochManager manager;
+        return manager;
+    }
+
+    // Frees p through deleter once no pinned thread can reach it. Must be
+    // called inside a guard.
+    void retire(void* p, void (*deleter)(void*));
+
+    void pin();
+    void unpin();
+
+    ~EpochManager();
+
+private:
+    struct Retired {
+        void* p;
+        void (*deleter)(void*);
+    };
+    // One bucket per epoch residue; a bucket tagged with epoch e is safe to
+    // free once the global epoch reaches e + 2.
+    struct Limbo {
+        uint64_t epoch = 0;
+        std::vector<Retired> items;
+    };
+    struct alignas(64) Slot {
+        // 0 when the owning thread is outside any guard.
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> in_use{false};
+    };
+    struct ThreadState {
+        size_t slot = MAX_THREADS;
+        size_t depth = 0;  // Nested guards
+        size_t retired_since_advance = 0;
+        std::array<Limbo, 3> limbo;
+        ~ThreadState();
+    };
+
+    EpochManager() = default;
+
+    ThreadState& local();
+    void try_advance();
+    static void drain(std::vector<Retired>& items);
+    void collect(ThreadState& state, uint64_t epoch);
+
+    std::array<Slot, MAX_THREADS> slots;
+    std::atomic<uint64_t> global_epoch{1};
+    // Retired memory left behind by exited threads.
+    std::mutex orphan_mutex;
+    std::vector<Limbo> orphans;
+
+    friend struct ThreadState;
+};
+
+// Pins the current epoch for its lifetime; guards may nest.
+class EpochGuard {
+public:
+    EpochGuard() { EpochManager::instance().pin(); }
+    ~EpochGuard() { EpochManager::instance().unpin(); }
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+inline EpochManager::ThreadState& EpochManager::local() {
+    thread_local ThreadState state;
+    if (state.slot == MAX_THREADS) {
+        for (size_t i = 0; i < MAX_THREADS; ++i) {
+            bool expected = false;
+            if (!slots[i].in_use.load(std::memory_order_relaxed) &&
+                slots[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                state.slot = i;
+                break;
+            }
+        }
+        if (state.slot == MAX_THREADS) {
+            throw std::runtime_error("EpochManager: more than MAX_THREADS concurrent threads");
+        }
+    }
+    return state;
+}
+
+inline void EpochManager::pin() {
+    ThreadState& state = local();
+    if (state.depth++ == 0) {
+        // seq_cst so the announcement is visible before any shared load.
+        slots[state.slot].epoch.store(global_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+}
+
+inline void EpochManager::unpin() {
+    ThreadState& state = local();
+    if (--state.depth == 0) {
+        slots[state.slot].epoch.store(0, std::memory_order_release);
+    }
+}
+
+inline void EpochManager::drain(std::vector<Retired>& items) {
+    for (const Retired& r : items) {
+        r.deleter(r.p);
+    }
+    items.clear();
+}
+
+inline void EpochManager::collect(ThreadState& state, uint64_t epoch) {
+    for (Limbo& bucket : state.limbo) {
+        if (!bucket.items.empty() && bucket.epoch + 2 <= epoch) {
+            drain(bucket.items);
+        }
+    }
+    std::unique_lock<std::mutex> lock(orphan_mutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+        for (size_t i = 0; i < orphans.size();) {
+            if (orphans[i].epoch + 2 <= epoch) {
+                drain(orphans[i].items);
+                orphans[i] = std::move(orphans.back());
+                orphans.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+}
+
+inline void EpochManager::try_advance() {
+    uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+    for (const Slot& slot : slots) {
+        if (!slot.in_use.load(std::memory_order_acquire)) continue;
+        uint64_t seen = slot.epoch.load(std::memory_order_seq_cst);
+        if (seen != 0 && seen != epoch) return;  // Someone is still behind
+    }
+    global_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+}
+
+inline void EpochManager::retire(void* p, void (*deleter)(void*)) {
+    ThreadState& state = local();
+    uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+    Limbo& bucket = state.limbo[epoch % 3];
+    if (bucket.epoch != epoch) {
+        // The bucket last held epoch - 3 or earlier, which is past the grace
+        // period now.
+        drain(bucket.items);
+        bucket.epoch = epoch;
+    }
+    bucket.items.push_back({p, deleter});
+
+    if (++state.retired_since_advance >= ADVANCE_INTERVAL) {
+        state.retired_since_advance = 0;
+        try_advance();
+        collect(state, global_epoch.load(std::memory_order_seq_cst));
+    }
+}
+
+inline EpochManager::ThreadState::~ThreadState() {
+    if (slot == MAX_THREADS) return;
+    EpochManager& manager = EpochManager::instance();
+    {
+        std::lock_guard<std::mutex> lock(manager.orphan_mutex);
+        for (Limbo& bucket : limbo) {
+            if (!bucket.items.empty()) {
+                manager.orphans.push_back(std::move(bucket));
+            }
+        }
+    }
+    manager.slots[slot].epoch.store(0, std::memory_order_release);
+    manager.slots[slot].in_use.store(false, std::memory_order_release);
+}
+
+inline EpochManager::~EpochManager() {
+    // Static destruction: no other thread may still be running.
+    for (Limbo& bucket : orphans) {
+        drain(bucket.items);
+    }
+}
+
+#endif
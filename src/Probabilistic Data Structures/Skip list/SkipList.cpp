@@ -1,18 +1,197 @@
+#ifndef SKIP_LIST_CPP
+#define SKIP_LIST_CPP
+
+// SkipList is a template, so this file is included rather than compiled
+// on its own; the guard lets SkipMap.hpp and its users both include it.
 #include "SkipList.hpp"
 
-template<typename T>
-SkipList<T>::SkipList() 
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+template<typename T, bool Indexable, class Stats, class Compare>
+SkipList<T, Indexable, Stats, Compare>::Arena::Arena(Arena&& other) noexcept
+    : chunks(std::move(other.chunks))
+    , free_lists(std::move(other.free_lists))
+    , cursor(std::exchange(other.cursor, nullptr))
+    , remaining(std::exchange(other.remaining, 0))
+    , next_chunk(std::exchange(other.next_chunk, MIN_CHUNK))
+    , reserved(std::exchange(other.reserved, 0)) {}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+typename SkipList<T, Indexable, Stats, Compare>::Arena& SkipList<T, Indexable, Stats, Compare>::Arena::operator=(Arena&& other) noexcept {
+    if (this != &other) {
+        chunks = std::move(other.chunks);
+        free_lists = std::move(other.free_lists);
+        cursor = std::exchange(other.cursor, nullptr);
+        remaining = std::exchange(other.remaining, 0);
+        next_chunk = std::exchange(other.next_chunk, MIN_CHUNK);
+        reserved = std::exchange(other.reserved, 0);
+    }
+    return *this;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+void* SkipList<T, Indexable, Stats, Compare>::Arena::allocate(size_t level) {
+    if (level < free_lists.size() && free_lists[level]) {
+        void* p = free_lists[level];
+        free_lists[level] = *static_cast<void**>(p);
+        return p;
+    }
+    constexpr size_t align = alignof(Node);
+    size_t bytes = (Node::bytes(level) + align - 1) & ~(align - 1);
+    if (bytes > remaining) {
+        size_t chunk = std::max(next_chunk, bytes);
+        chunks.push_back(std::make_unique<unsigned char[]>(chunk));
+        cursor = chunks.back().get();
+        remaining = chunk;
+        reserved += chunk;
+        next_chunk = std::min(next_chunk * 2, MAX_CHUNK);
+    }
+    void* p = cursor;
+    cursor += bytes;
+    remaining -= bytes;
+    return p;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+void SkipList<T, Indexable, Stats, Compare>::Arena::release(void* p, size_t level) {
+    if (level >= free_lists.size()) {
+        free_lists.resize(level + 1, nullptr);
+    }
+    *static_cast<void**>(p) = free_lists[level];
+    free_lists[level] = p;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+typename SkipList<T, Indexable, Stats, Compare>::Node* SkipList<T, Indexable, Stats, Compare>::create_head() {
+    void* p = arena.allocate(MAX_LEVEL);
+    Node* node = new (p) Node(MAX_LEVEL);
+    for (size_t i = 0; i < MAX_LEVEL; i++) {
+        node->forward()[i] = nullptr;
+    }
+    if constexpr (Indexable) {
+        for (size_t i = 0; i < MAX_LEVEL; i++) {
+            node->width()[i] = 1;
+        }
+    }
+    return node;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename Make>
+typename SkipList<T, Indexable, Stats, Compare>::Node* SkipList<T, Indexable, Stats, Compare>::create_node(size_t level, Make&& make) {
+    void* p = arena.allocate(level);
+    Node* node;
+    try {
+        node = new (p) Node(level, std::forward<Make>(make));
+    } catch (...) {
+        arena.release(p, level);
+        throw;
+    }
+    for (size_t i = 0; i < level; i++) {
+        node->forward()[i] = nullptr;
+    }
+    if constexpr (Indexable) {
+        for (size_t i = 0; i < level; i++) {
+            node->width()[i] = 1;
+        }
+    }
+    return node;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+void SkipList<T, Indexable, Stats, Compare>::destroy_node(Node* node) {
+    size_t level = node->level;
+    node->value.~T();
+    arena.release(node, level);
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+SkipList<T, Indexable, Stats, Compare>::SkipList(const Compare& comp)
     : current_level(1)
-    , gen(rd())
-    , dis(0.0, 1.0) {
-    head = std::make_shared<Node>(
-        std::numeric_limits<T>::lowest(),
-        MAX_LEVEL
-    );
+    , count(0)
+    , gen(std::random_device{}())
+    , dis(0.0, 1.0)
+    , comp(comp) {
+    head = create_head();
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+void SkipList<T, Indexable, Stats, Compare>::destroy_all() {
+    // The arena frees the memory in bulk; only the values need destroying.
+    if (!head) return;
+    Node* current = head->forward()[0];
+    while (current) {
+        Node* next = current->forward()[0];
+        current->value.~T();
+        current = next;
+    }
+    head = nullptr;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+void SkipList<T, Indexable, Stats, Compare>::clear() {
+    Node* current = head->forward()[0];
+    while (current) {
+        Node* next = current->forward()[0];
+        destroy_node(current);
+        current = next;
+    }
+    for (size_t i = 0; i < MAX_LEVEL; i++) {
+        head->forward()[i] = nullptr;
+    }
+    if constexpr (Indexable) head->width()[0] = 1;
+    current_level = 1;
+    count = 0;
+    counters.update([](SkipListStats& s) { s.level_histogram = {}; });
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+void SkipList<T, Indexable, Stats, Compare>::reset_stats() {
+    counters.update([](SkipListStats& s) {
+        s.searches = 0;
+        s.search_steps = 0;
+    });
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+SkipList<T, Indexable, Stats, Compare>::~SkipList() {
+    destroy_all();
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+SkipList<T, Indexable, Stats, Compare>::SkipList(SkipList&& other) : SkipList(other.comp) {
+    // other is left with the fresh head built here, so it stays usable
+    swap(other);
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+SkipList<T, Indexable, Stats, Compare>& SkipList<T, Indexable, Stats, Compare>::operator=(SkipList&& other) {
+    if (this != &other) {
+        SkipList taken(std::move(other));
+        swap(taken);
+    }
+    return *this;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+void SkipList<T, Indexable, Stats, Compare>::swap(SkipList& other) noexcept {
+    using std::swap;
+    swap(arena, other.arena);
+    swap(head, other.head);
+    swap(current_level, other.current_level);
+    swap(count, other.count);
+    swap(gen, other.gen);
+    swap(dis, other.dis);
+    swap(comp, other.comp);
+    swap(counters, other.counters);
 }
 
-template<typename T>
-size_t SkipList<T>::random_level() const {
+template<typename T, bool Indexable, class Stats, class Compare>
+size_t SkipList<T, Indexable, Stats, Compare>::random_level() {
     size_t level = 1;
     while (dis(gen) < P && level < MAX_LEVEL) {
         level++;
@@ -20,129 +199,450 @@ size_t SkipList<T>::random_level() const {
     return level;
 }
 
-template<typename T>
-bool SkipList<T>::insert(const T& value) {
-    std::vector<std::shared_ptr<Node>> update(MAX_LEVEL);
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename K>
+void SkipList<T, Indexable, Stats, Compare>::find_predecessors(const K& key, Node** update, size_t* update_rank) const {
+    size_t position = 0;
+    size_t steps = 0;
     auto current = head;
     for (int i = current_level - 1; i >= 0; i--) {
-        while (current->forward[i] && current->forward[i]->value < value) {
-            current = current->forward[i];
+        while (current->forward()[i] && comp(current->forward()[i]->value, key)) {
+            if constexpr (Indexable) position += current->width()[i];
+            current = current->forward()[i];
+            steps++;
         }
         update[i] = current;
+        update_rank[i] = position;
     }
-    current = current->forward[0];
-    if (current && current->value == value) {
-        return false;
-    }
-    size_t new_level = random_level();
+    count_search(steps);
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+void SkipList<T, Indexable, Stats, Compare>::link_node(Node** update, size_t* update_rank, Node* new_node) {
+    size_t new_level = new_node->level;
     if (new_level > current_level) {
         for (size_t i = current_level; i < new_level; i++) {
             update[i] = head;
+            update_rank[i] = 0;
+            if constexpr (Indexable) head->width()[i] = count + 1;
         }
         current_level = new_level;
     }
-    auto new_node = std::make_shared<Node>(value, new_level);
+    count_tower(new_level, true);
     for (size_t i = 0; i < new_level; i++) {
-        new_node->forward[i] = update[i]->forward[i];
-        update[i]->forward[i] = new_node;
+        new_node->forward()[i] = update[i]->forward()[i];
+        update[i]->forward()[i] = new_node;
+        if constexpr (Indexable) {
+            // new_node lands at update_rank[0] + 1 and splits the old span.
+            size_t before = update_rank[0] - update_rank[i] + 1;
+            new_node->width()[i] = update[i]->width()[i] + 1 - before;
+            update[i]->width()[i] = before;
+        }
     }
-    
+    if constexpr (Indexable) {
+        for (size_t i = new_level; i < current_level; i++) {
+            update[i]->width()[i]++;
+        }
+    }
+    size_t new_rank = update_rank[0] + 1;
+    for (size_t i = 0; i < new_level; i++) {
+        update[i] = new_node;
+        update_rank[i] = new_rank;
+    }
+    count++;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename K, typename Make>
+std::pair<typename SkipList<T, Indexable, Stats, Compare>::Node*, bool>
+SkipList<T, Indexable, Stats, Compare>::insert_with(const K& key, Make&& make) {
+    Node* update[MAX_LEVEL];
+    size_t update_rank[MAX_LEVEL];
+    find_predecessors(key, update, update_rank);
+    Node* next = update[0]->forward()[0];
+    if (holds(next, key)) {
+        return {next, false};
+    }
+    Node* new_node = create_node(random_level(), std::forward<Make>(make));
+    link_node(update, update_rank, new_node);
+    return {new_node, true};
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+bool SkipList<T, Indexable, Stats, Compare>::insert(const T& value) {
+    return insert_with(value, [&]() -> T { return value; }).second;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+bool SkipList<T, Indexable, Stats, Compare>::insert(T&& value) {
+    return insert_with(value, [&]() -> T { return std::move(value); }).second;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename... Args>
+bool SkipList<T, Indexable, Stats, Compare>::emplace(Args&&... args) {
+    // The value has to exist before it can be searched for, so it is built
+    // in its node up front
+    Node* new_node = create_node(random_level(), [&]() -> T { return T(std::forward<Args>(args)...); });
+    Node* update[MAX_LEVEL];
+    size_t update_rank[MAX_LEVEL];
+    find_predecessors(new_node->value, update, update_rank);
+    if (holds(update[0]->forward()[0], new_node->value)) {
+        destroy_node(new_node);
+        return false;
+    }
+    link_node(update, update_rank, new_node);
     return true;
 }
 
-template<typename T>
-bool SkipList<T>::remove(const T& value) {
-    std::vector<std::shared_ptr<Node>> update(MAX_LEVEL);
-    auto current = head;
-    for (int i = current_level - 1; i >= 0; i--) {
-        while (current->forward[i] && current->forward[i]->value < value) {
-            current = current->forward[i];
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename InputIt>
+size_t SkipList<T, Indexable, Stats, Compare>::insert_batch(InputIt first, InputIt last) {
+    // update[i] and its rank stay valid for the next value as long as that
+    // value is not smaller than the previous one.
+    Node* update[MAX_LEVEL];
+    size_t update_rank[MAX_LEVEL];
+    std::fill(update, update + MAX_LEVEL, head);
+    std::fill(update_rank, update_rank + MAX_LEVEL, size_t(0));
+    size_t inserted = 0;
+    for (; first != last; ++first) {
+        const T& value = *first;
+        if (update[0] != head && !comp(update[0]->value, value)) {
+            if (!comp(value, update[0]->value)) continue;  // Just inserted it
+            std::fill(update, update + MAX_LEVEL, head);
+            std::fill(update_rank, update_rank + MAX_LEVEL, size_t(0));
+        }
+        // A finger is stale where its successor is below value. If level i
+        // is still valid so is every level above, so only the lowest few
+        // levels are searched again, each from the further of the finger
+        // and where the level above ended.
+        size_t stale = 0;
+        while (stale < current_level && update[stale]->forward()[stale] &&
+               comp(update[stale]->forward()[stale]->value, value)) {
+            stale++;
+        }
+        Node* current = stale < current_level ? update[stale] : head;
+        size_t position = stale < current_level ? update_rank[stale] : 0;
+        for (int i = static_cast<int>(stale) - 1; i >= 0; i--) {
+            if (current == head || (update[i] != head && comp(current->value, update[i]->value))) {
+                current = update[i];
+                position = update_rank[i];
+            }
+            while (current->forward()[i] && comp(current->forward()[i]->value, value)) {
+                if constexpr (Indexable) position += current->width()[i];
+                current = current->forward()[i];
+            }
+            update[i] = current;
+            update_rank[i] = position;
+        }
+        if (holds(update[0]->forward()[0], value)) continue;
+        link_node(update, update_rank, create_node(random_level(), [&]() -> T { return value; }));
+        inserted++;
+    }
+    return inserted;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename InputIt>
+void SkipList<T, Indexable, Stats, Compare>::bulk_load(InputIt first, InputIt last) {
+    // Element k (1-based) gets 1 + ctz(k) levels: every other element
+    // reaches level 2, every fourth level 3, and so on.
+    load_towers(first, last, [](size_t k) { return std::min<size_t>(1 + __builtin_ctzll(k), MAX_LEVEL); });
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename InputIt, typename LevelOf>
+void SkipList<T, Indexable, Stats, Compare>::load_towers(InputIt first, InputIt last, LevelOf level_of) {
+    clear();
+    Node* tail[MAX_LEVEL];
+    size_t tail_rank[MAX_LEVEL];
+    std::fill(tail, tail + MAX_LEVEL, head);
+    std::fill(tail_rank, tail_rank + MAX_LEVEL, size_t(0));
+    for (; first != last; ++first) {
+        const T& value = *first;
+        if (count > 0) {
+            if (comp(value, tail[0]->value)) {
+                throw std::invalid_argument("SkipList::bulk_load: input is not sorted");
+            }
+            if (!comp(tail[0]->value, value)) continue;
+        }
+        size_t k = count + 1;
+        size_t new_level = level_of(k);
+        Node* new_node = create_node(new_level, [&]() -> T { return value; });
+        count_tower(new_level, true);
+        for (size_t i = 0; i < new_level; i++) {
+            tail[i]->forward()[i] = new_node;
+            if constexpr (Indexable) tail[i]->width()[i] = k - tail_rank[i];
+            tail[i] = new_node;
+            tail_rank[i] = k;
+        }
+        current_level = std::max(current_level, new_level);
+        count = k;
+    }
+    if constexpr (Indexable) {
+        for (size_t i = 0; i < current_level; i++) {
+            tail[i]->width()[i] = count + 1 - tail_rank[i];
         }
-        update[i] = current;
     }
-    current = current->forward[0];
-    if (!current || current->value != value) {
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename K>
+bool SkipList<T, Indexable, Stats, Compare>::remove_key(const K& key) {
+    Node* update[MAX_LEVEL];
+    size_t update_rank[MAX_LEVEL];
+    find_predecessors(key, update, update_rank);
+    Node* current = update[0]->forward()[0];
+    if (!holds(current, key)) {
         return false;
     }
     for (size_t i = 0; i < current_level; i++) {
-        if (update[i]->forward[i] != current) {
+        if (update[i]->forward()[i] != current) {
+            if constexpr (Indexable) {
+                // Spans passing over the node shrink by one.
+                for (; i < current_level; i++) {
+                    update[i]->width()[i]--;
+                }
+            }
             break;
         }
-        update[i]->forward[i] = current->forward[i];
+        update[i]->forward()[i] = current->forward()[i];
+        if constexpr (Indexable) update[i]->width()[i] += current->width()[i] - 1;
     }
-    while (current_level > 1 && !head->forward[current_level - 1]) {
+    count_tower(current->level, false);
+    destroy_node(current);
+    count--;
+    while (current_level > 1 && !head->forward()[current_level - 1]) {
         current_level--;
     }
     
     return true;
 }
 
-template<typename T>
-bool SkipList<T>::contains(const T& value) const {
-    auto current = head;
-    
-    for (int i = current_level - 1; i >= 0; i--) {
-        while (current->forward[i] && current->forward[i]->value < value) {
-            current = current->forward[i];
-        }
-    }
-    
-    current = current->forward[0];
-    return (current && current->value == value);
-}
-
-template<typename T>
-bool SkipList<T>::empty() const {
-    return head->forward[0] == nullptr;
+template<typename T, bool Indexable, class Stats, class Compare>
+bool SkipList<T, Indexable, Stats, Compare>::empty() const {
+    return count == 0;
 }
 
-template<typename T>
-size_t SkipList<T>::size() const {
-    size_t count = 0;
-    auto current = head->forward[0];
-    while (current) {
-        count++;
-        current = current->forward[0];
-    }
+template<typename T, bool Indexable, class Stats, class Compare>
+size_t SkipList<T, Indexable, Stats, Compare>::size() const {
     return count;
 }
 
-template<typename T>
-std::optional<T> SkipList<T>::find_min() const {
+template<typename T, bool Indexable, class Stats, class Compare>
+std::optional<T> SkipList<T, Indexable, Stats, Compare>::find_min() const {
     if (empty()) {
         return std::nullopt;
     }
-    return head->forward[0]->value;
+    return head->forward()[0]->value;
 }
 
-template<typename T>
-std::optional<T> SkipList<T>::find_max() const {
+template<typename T, bool Indexable, class Stats, class Compare>
+std::optional<T> SkipList<T, Indexable, Stats, Compare>::find_max() const {
     if (empty()) {
         return std::nullopt;
     }
     auto current = head;
     for (size_t i = current_level - 1; i != SIZE_MAX; i--) {
-        while (current->forward[i]) {
-            current = current->forward[i];
+        while (current->forward()[i]) {
+            current = current->forward()[i];
         }
         if (i == 0) break;
     }
     return current->value;
 }
 
-template<typename T>
-std::vector<T> SkipList<T>::range(const T& start, const T& end) const {
-    std::vector<T> result;
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename K>
+typename SkipList<T, Indexable, Stats, Compare>::Node* SkipList<T, Indexable, Stats, Compare>::first_not_less(const K& key) const {
+    auto current = head;
+    size_t steps = 0;
+    for (int i = current_level - 1; i >= 0; i--) {
+        while (current->forward()[i] && comp(current->forward()[i]->value, key)) {
+            current = current->forward()[i];
+            steps++;
+        }
+    }
+    count_search(steps);
+    return current->forward()[0];
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename K>
+typename SkipList<T, Indexable, Stats, Compare>::Node* SkipList<T, Indexable, Stats, Compare>::first_greater(const K& key) const {
     auto current = head;
     for (int i = current_level - 1; i >= 0; i--) {
-        while (current->forward[i] && current->forward[i]->value < start) {
-            current = current->forward[i];
+        while (current->forward()[i] && !comp(key, current->forward()[i]->value)) {
+            current = current->forward()[i];
         }
     }
-    current = current->forward[0];
-    while (current && current->value <= end) {
-        result.push_back(current->value);
-        current = current->forward[0];
+    return current->forward()[0];
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename K>
+std::vector<T> SkipList<T, Indexable, Stats, Compare>::copy_range(const K& start, const K& end) const {
+    std::vector<T> result;
+    if constexpr (Indexable) {
+        result.reserve(count_between(start, end));
+    }
+    for (auto it = const_iterator(first_not_less(start)); it != this->end() && !comp(end, *it); ++it) {
+        result.push_back(*it);
     }
     return result;
-}
\ No newline at end of file
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename K>
+size_t SkipList<T, Indexable, Stats, Compare>::count_below(const K& key, bool inclusive) const {
+    static_assert(Indexable, "order statistics need SkipList<T, true>");
+    size_t position = 0;
+    auto current = head;
+    for (int i = current_level - 1; i >= 0; i--) {
+        while (current->forward()[i] &&
+               (inclusive ? !comp(key, current->forward()[i]->value) : comp(current->forward()[i]->value, key))) {
+            position += current->width()[i];
+            current = current->forward()[i];
+        }
+    }
+    return position;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+const T& SkipList<T, Indexable, Stats, Compare>::at(size_t index) const {
+    static_assert(Indexable, "order statistics need SkipList<T, true>");
+    if (index >= count) {
+        throw std::out_of_range("SkipList::at: index out of range");
+    }
+    size_t remaining = index + 1;  // Steps still to take from head
+    auto current = head;
+    for (int i = current_level - 1; i >= 0; i--) {
+        while (current->forward()[i] && current->width()[i] <= remaining) {
+            remaining -= current->width()[i];
+            current = current->forward()[i];
+        }
+    }
+    return current->value;
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+template<typename K>
+size_t SkipList<T, Indexable, Stats, Compare>::count_between(const K& start, const K& end) const {
+    if (comp(end, start)) {
+        return 0;
+    }
+    return count_below(end, true) - count_below(start, false);
+}
+
+template<typename T, bool Indexable, class Stats, class Compare>
+void SkipList<T, Indexable, Stats, Compare>::save(const std::string& path) const {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshots store values as raw bytes");
+    snapshot::Writer out(path, snapshot::Kind::SKIP_LIST, sizeof(T), {count});
+    // Streamed through a small buffer rather than gathered in one copy
+    constexpr size_t BUFFER = 4096;
+    std::vector<T> values;
+    values.reserve(BUFFER);
+    for (const Node* node = head->forward()[0]; node; node = node->forward()[0]) {
+        values.push_back(node->value);
+        if (values.size() == BUFFER || !node->forward()[0]) {
+            out.append(values.data(), values.size() * sizeof(T));
+            values.clear();
+        }
+    }
+    out.end_section();
+    uint8_t heights[BUFFER];
+    size_t buffered = 0;
+    for (const Node* node = head->forward()[0]; node; node = node->forward()[0]) {
+        heights[buffered++] = static_cast<uint8_t>(node->level);
+        if (buffered == BUFFER || !node->forward()[0]) {
+            out.append(heights, buffered);
+            buffered = 0;
+        }
+    }
+    out.end_section();
+    out.commit();
+}
+
+template<typename T, class Compare>
+SkipListSnapshot<T, Compare>::SkipListSnapshot(const std::string& path, const Compare& comp)
+    : comp(comp) {
+    snapshot::Reader reader(path, snapshot::Kind::SKIP_LIST, sizeof(T));
+    size_t n = reader.field(0);
+    keys = reader.take<T>(n);
+    levels = reader.take<uint8_t>(n);
+}
+
+template<typename T, class Compare>
+bool SkipListSnapshot<T, Compare>::contains(const T& value) const {
+    const_iterator it = lower_bound(value);
+    return it != end() && !comp(value, *it);
+}
+
+template<typename T, class Compare>
+std::optional<T> SkipListSnapshot<T, Compare>::find_min() const {
+    if (empty()) {
+        return std::nullopt;
+    }
+    return keys[0];
+}
+
+template<typename T, class Compare>
+std::optional<T> SkipListSnapshot<T, Compare>::find_max() const {
+    if (empty()) {
+        return std::nullopt;
+    }
+    return keys[keys.size() - 1];
+}
+
+template<typename T, class Compare>
+typename SkipListSnapshot<T, Compare>::const_iterator SkipListSnapshot<T, Compare>::lower_bound(const T& value) const {
+    return std::lower_bound(begin(), end(), value, comp);
+}
+
+template<typename T, class Compare>
+typename SkipListSnapshot<T, Compare>::const_iterator SkipListSnapshot<T, Compare>::upper_bound(const T& value) const {
+    return std::upper_bound(begin(), end(), value, comp);
+}
+
+template<typename T, class Compare>
+std::vector<T> SkipListSnapshot<T, Compare>::range(const T& start, const T& end) const {
+    if (comp(end, start)) {
+        return {};
+    }
+    return std::vector<T>(lower_bound(start), upper_bound(end));
+}
+
+template<typename T, class Compare>
+const T& SkipListSnapshot<T, Compare>::at(size_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("SkipListSnapshot::at: index out of range");
+    }
+    return keys[index];
+}
+
+template<typename T, class Compare>
+size_t SkipListSnapshot<T, Compare>::count_range(const T& start, const T& end) const {
+    if (comp(end, start)) {
+        return 0;
+    }
+    return upper_bound(end) - lower_bound(start);
+}
+
+template<typename T, class Compare>
+template<bool Indexable, class Stats>
+SkipList<T, Indexable, Stats, Compare> SkipListSnapshot<T, Compare>::thaw() const {
+    SkipList<T, Indexable, Stats, Compare> list(comp);
+    list.load_towers(begin(), end(), [this](size_t k) {
+        size_t level = levels[k - 1];
+        if (level == 0 || level > SkipListStats::LEVELS) {
+            throw std::invalid_argument("SkipListSnapshot::thaw: tower height out of range");
+        }
+        return level;
+    });
+    if (list.size() != size()) {
+        throw std::invalid_argument("SkipListSnapshot::thaw: repeated values");
+    }
+    return list;
+}
+
+#endif
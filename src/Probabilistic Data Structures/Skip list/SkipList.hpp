@@ -1,51 +1,337 @@
 #ifndef SKIP_LIST_HPP
 #define SKIP_LIST_HPP
 
+#include "../../stats.hpp"
+#include "../snapshot.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <random>
 #include <vector>
 #include <optional>
-#include <limits>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <utility>
+
+// Instrumentation snapshot of a SkipList counted with stats::Count. Only
+// searches made by insert, remove, contains and lower_bound are counted.
+struct SkipListStats {
+    static constexpr size_t LEVELS = 16;
+
+    uint64_t searches = 0;
+    // Forward pointers followed plus levels descended, over all searches
+    uint64_t search_steps = 0;
+    // Live elements by tower height; entry i counts towers of i + 1 levels
+    std::array<uint64_t, LEVELS> level_histogram{};
+
+    [[nodiscard]] double average_path_length() const {
+        return searches == 0 ? 0.0 : static_cast<double>(search_steps) / searches;
+    }
+};
+
+template<typename T, class Compare = std::less<T>>
+class SkipListSnapshot;
+template<typename K, typename V, class Compare>
+class SkipMap;
 
-template<typename T>
+// With Indexable set, every forward pointer also records its span width
+// (how many level-0 steps it skips), which gives O(log n) rank(), at() and
+// count_range() for one extra word per tower level. Stats is stats::None
+// or stats::Count; see stats.hpp.
+//
+// Values are ordered by Compare and two values are the same when neither
+// is less than the other. With a transparent Compare such as std::less<>
+// the lookups also take any key type it can compare with T, for instance
+// a std::string_view into a SkipList<std::string>, without building a
+// temporary T. The head tower holds no value, so T needs neither a default
+// constructor nor a lowest value.
+template<typename T, bool Indexable = false, class Stats = stats::None, class Compare = std::less<T>>
 class SkipList {
 private:
+    // A node is its header followed directly by `level` forward pointers
+    // (and, when Indexable, `level` widths), carved out of the list's arena
+    // in one piece. A width of the last node on a level counts up to one
+    // past the end of the list.
     struct Node {
-        T value;
-        std::vector<std::shared_ptr<Node>> forward;
-        
-        explicit Node(const T& val, size_t level) 
-            : value(val), forward(level, nullptr) {}
+        size_t level;
+        union {
+            T value;  // Never constructed in the head
+        };
+
+        explicit Node(size_t level) : level(level) {}
+        // Constructs the value from make()'s result in place
+        template<typename Make>
+        Node(size_t level, Make&& make) : level(level), value(make()) {}
+        ~Node() {}
+        Node** forward() { return reinterpret_cast<Node**>(this + 1); }
+        Node* const* forward() const { return reinterpret_cast<Node* const*>(this + 1); }
+        size_t* width() { return reinterpret_cast<size_t*>(forward() + level); }
+        const size_t* width() const { return reinterpret_cast<const size_t*>(forward() + level); }
+        static size_t bytes(size_t level) {
+            return sizeof(Node) + level * (sizeof(Node*) + (Indexable ? sizeof(size_t) : 0));
+        }
+    };
+    static_assert(sizeof(Node) % alignof(Node*) == 0, "tower must follow the header aligned");
+
+    // Bump allocator for nodes. Memory comes in chunks that grow from
+    // MIN_CHUNK to MAX_CHUNK bytes; freed nodes go on a free list per level
+    // and are handed out again to nodes of the same height. Everything is
+    // returned at once when the arena is destroyed.
+    class Arena {
+    public:
+        Arena() = default;
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+        Arena(Arena&& other) noexcept;
+        Arena& operator=(Arena&& other) noexcept;
+
+        [[nodiscard]] void* allocate(size_t level);
+        void release(void* p, size_t level);
+        [[nodiscard]] size_t bytes_reserved() const { return reserved; }
+
+    private:
+        static constexpr size_t MIN_CHUNK = 4096;
+        static constexpr size_t MAX_CHUNK = 1 << 20;
+
+        std::vector<std::unique_ptr<unsigned char[]>> chunks;
+        std::vector<void*> free_lists;  // Indexed by level; next pointer stored in the node
+        unsigned char* cursor = nullptr;
+        size_t remaining = 0;
+        size_t next_chunk = MIN_CHUNK;
+        size_t reserved = 0;
     };
+
     static constexpr float P = 0.5f;
-    static constexpr size_t MAX_LEVEL = 16;  
-    std::shared_ptr<Node> head;
+    static constexpr size_t MAX_LEVEL = SkipListStats::LEVELS;
+    Arena arena;
+    Node* head;
     size_t current_level;
-    std::random_device rd;
+    size_t count;
     std::mt19937 gen;
     std::uniform_real_distribution<> dis;
-    [[nodiscard]] size_t random_level() const;
-    
+    Compare comp;
+    stats::Counters<Stats, SkipListStats> counters;
+    void count_search(size_t steps) const {
+        counters.update([&](SkipListStats& s) {
+            s.searches++;
+            s.search_steps += steps + current_level;
+        });
+    }
+    void count_tower(size_t level, bool added) {
+        counters.update([&](SkipListStats& s) {
+            if (added) {
+                s.level_histogram[level - 1]++;
+            } else {
+                s.level_histogram[level - 1]--;
+            }
+        });
+    }
+    [[nodiscard]] size_t random_level();
+    [[nodiscard]] Node* create_head();
+    void swap(SkipList& other) noexcept;
+    template<typename Make>
+    [[nodiscard]] Node* create_node(size_t level, Make&& make);
+    void destroy_node(Node* node);
+    void destroy_all();
+    // Whether node, the first one not less than key, holds key.
+    template<typename K>
+    [[nodiscard]] bool holds(const Node* node, const K& key) const { return node && !comp(key, node->value); }
+    // Number of elements less than (or, with inclusive, not greater than) key.
+    template<typename K>
+    [[nodiscard]] size_t count_below(const K& key, bool inclusive) const;
+    // First node not less than key, or nullptr.
+    template<typename K>
+    [[nodiscard]] Node* first_not_less(const K& key) const;
+    // First node greater than key, or nullptr.
+    template<typename K>
+    [[nodiscard]] Node* first_greater(const K& key) const;
+    // Fills update[i] with the last node below key on level i and, when
+    // Indexable, update_rank[i] with its position (head is 0).
+    template<typename K>
+    void find_predecessors(const K& key, Node** update, size_t* update_rank) const;
+    // Links new_node after the predecessors update[0..new_node->level) at
+    // positions update_rank[], then moves them onto the new node.
+    void link_node(Node** update, size_t* update_rank, Node* new_node);
+    // Inserts the value make() returns unless key is present; the value is
+    // only built once the search has found room for it. Returns the node
+    // holding key and whether it is new.
+    template<typename K, typename Make>
+    std::pair<Node*, bool> insert_with(const K& key, Make&& make);
+    template<typename K>
+    bool remove_key(const K& key);
+    template<typename K>
+    [[nodiscard]] std::vector<T> copy_range(const K& start, const K& end) const;
+    template<typename K>
+    [[nodiscard]] size_t count_between(const K& start, const K& end) const;
+    // Replaces the contents with the ascending sequence [first, last); the
+    // k-th new element (1-based) gets level_of(k) levels.
+    template<typename InputIt, typename LevelOf>
+    void load_towers(InputIt first, InputIt last, LevelOf level_of);
+
+    template<typename, class>
+    friend class SkipListSnapshot;
+    template<typename, typename, class>
+    friend class SkipMap;
+
 public:
-    SkipList();
-    ~SkipList() = default;
+    // Forward iterator over the values in ascending order. Values cannot be
+    // modified in place since that could break the ordering. Valid until
+    // the element it points at is removed.
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+        reference operator*() const { return node->value; }
+        pointer operator->() const { return &node->value; }
+        const_iterator& operator++() {
+            node = node->forward()[0];
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            node = node->forward()[0];
+            return old;
+        }
+        friend bool operator==(const const_iterator& a, const const_iterator& b) { return a.node == b.node; }
+        friend bool operator!=(const const_iterator& a, const const_iterator& b) { return a.node != b.node; }
+
+    private:
+        friend class SkipList;
+        explicit const_iterator(const Node* node) : node(node) {}
+        const Node* node = nullptr;
+    };
+    using iterator = const_iterator;
+
+    SkipList() : SkipList(Compare()) {}
+    explicit SkipList(const Compare& comp);
+    ~SkipList();
     // no copying!!!
     SkipList(const SkipList&) = delete;
     SkipList& operator=(const SkipList&) = delete;
-    //  moving
-    SkipList(SkipList&&) = default;
-    SkipList& operator=(SkipList&&) = default;
-    // Core 
+    //  moving; other is left empty and can be used again, which costs it
+    // a fresh head tower
+    SkipList(SkipList&& other);
+    SkipList& operator=(SkipList&& other);
+    // Core
     [[nodiscard]] bool insert(const T& value);
-    [[nodiscard]] bool remove(const T& value);
-    [[nodiscard]] bool contains(const T& value) const;
-    // Utility 
+    // Moves value into its node, or leaves it alone if already present.
+    [[nodiscard]] bool insert(T&& value);
+    // Builds the value from args directly in a new node, which is discarded
+    // again if the value is already present.
+    template<typename... Args>
+    [[nodiscard]] bool emplace(Args&&... args);
+    [[nodiscard]] bool remove(const T& value) { return remove_key(value); }
+    [[nodiscard]] bool contains(const T& value) const { return holds(first_not_less(value), value); }
+    // Heterogeneous lookups, for a transparent Compare only
+    template<typename K, typename C = Compare, typename = typename C::is_transparent>
+    [[nodiscard]] bool remove(const K& key) { return remove_key(key); }
+    template<typename K, typename C = Compare, typename = typename C::is_transparent>
+    [[nodiscard]] bool contains(const K& key) const { return holds(first_not_less(key), key); }
+    // Utility
     [[nodiscard]] bool empty() const;
     [[nodiscard]] size_t size() const;
     [[nodiscard]] std::optional<T> find_min() const;
     [[nodiscard]] std::optional<T> find_max() const;
+    // Bytes held by the node arena, including free space.
+    [[nodiscard]] size_t memory_usage() const { return arena.bytes_reserved(); }
+    // All zero unless Stats is stats::Count.
+    [[nodiscard]] SkipListStats stats() const { return counters.snapshot(); }
+    // Zeroes the search counters; the level histogram keeps describing the
+    // live elements.
+    void reset_stats();
+    void clear();
+    // Bulk operations
+    // Replaces the contents with the ascending sequence [first, last),
+    // building a perfectly balanced tower in O(n). Repeated values are
+    // skipped; throws std::invalid_argument if a value is out of order.
+    template<typename InputIt>
+    void bulk_load(InputIt first, InputIt last);
+    // Inserts [first, last), typically sorted: each search resumes from the
+    // previous insertion point instead of the head. Unsorted input is
+    // accepted but loses the speedup. Returns the number inserted.
+    template<typename InputIt>
+    size_t insert_batch(InputIt first, InputIt last);
+    // Writes the values in order and every tower's height to path (see
+    // snapshot.h); SkipListSnapshot<T> opens the file. T must be trivially
+    // copyable. Throws std::runtime_error on I/O errors.
+    void save(const std::string& path) const;
+    // Iteration
+    [[nodiscard]] const_iterator begin() const { return const_iterator(head->forward()[0]); }
+    [[nodiscard]] const_iterator end() const { return const_iterator(nullptr); }
+    [[nodiscard]] const_iterator lower_bound(const T& value) const { return const_iterator(first_not_less(value)); }
+    [[nodiscard]] const_iterator upper_bound(const T& value) const { return const_iterator(first_greater(value)); }
+    template<typename K, typename C = Compare, typename = typename C::is_transparent>
+    [[nodiscard]] const_iterator lower_bound(const K& key) const { return const_iterator(first_not_less(key)); }
+    template<typename K, typename C = Compare, typename = typename C::is_transparent>
+    [[nodiscard]] const_iterator upper_bound(const K& key) const { return const_iterator(first_greater(key)); }
     // Range operations
+    // Copies [start, end]; iterate lower_bound(start)..upper_bound(end) to
+    // avoid the allocation.
+    [[nodiscard]] std::vector<T> range(const T& start, const T& end) const { return copy_range(start, end); }
+    template<typename K, typename C = Compare, typename = typename C::is_transparent>
+    [[nodiscard]] std::vector<T> range(const K& start, const K& end) const { return copy_range(start, end); }
+    // Order statistics; Indexable lists only
+    // Number of elements less than value, i.e. its index if present.
+    [[nodiscard]] size_t rank(const T& value) const { return count_below(value, false); }
+    template<typename K, typename C = Compare, typename = typename C::is_transparent>
+    [[nodiscard]] size_t rank(const K& key) const { return count_below(key, false); }
+    // Element at 0-based position index; throws std::out_of_range.
+    [[nodiscard]] const T& at(size_t index) const;
+    // Number of elements in [start, end], the size of range(start, end).
+    [[nodiscard]] size_t count_range(const T& start, const T& end) const { return count_between(start, end); }
+    template<typename K, typename C = Compare, typename = typename C::is_transparent>
+    [[nodiscard]] size_t count_range(const K& start, const K& end) const { return count_between(start, end); }
+};
+
+// Read-only skip list over a file written by SkipList::save(). The sorted
+// values are mapped and binary searched in place, so opening costs nothing
+// beyond the page faults of the values a query touches, however large the
+// list. thaw() builds the mutable SkipList once one is needed: in O(n),
+// with the saved tower heights and no search or random draws.
+//
+// Opening checks only the header; thaw() throws std::invalid_argument if
+// the values are out of order or a height out of range.
+template<typename T, class Compare>
+class SkipListSnapshot {
+public:
+    using const_iterator = const T*;
+    using iterator = const_iterator;
+
+    // Throws std::runtime_error if path cannot be mapped and
+    // std::invalid_argument if it is not a snapshot of a SkipList<T>.
+    explicit SkipListSnapshot(const std::string& path, const Compare& comp = Compare());
+
+    [[nodiscard]] bool contains(const T& value) const;
+    [[nodiscard]] bool empty() const { return keys.size() == 0; }
+    [[nodiscard]] size_t size() const { return keys.size(); }
+    [[nodiscard]] std::optional<T> find_min() const;
+    [[nodiscard]] std::optional<T> find_max() const;
+    [[nodiscard]] const_iterator begin() const { return keys.begin(); }
+    [[nodiscard]] const_iterator end() const { return keys.end(); }
+    [[nodiscard]] const_iterator lower_bound(const T& value) const;
+    [[nodiscard]] const_iterator upper_bound(const T& value) const;
     [[nodiscard]] std::vector<T> range(const T& start, const T& end) const;
+    // Order statistics come free with the flat layout
+    [[nodiscard]] size_t rank(const T& value) const { return lower_bound(value) - begin(); }
+    // Throws std::out_of_range.
+    [[nodiscard]] const T& at(size_t index) const;
+    [[nodiscard]] size_t count_range(const T& start, const T& end) const;
+
+    template<bool Indexable = false, class Stats = stats::None>
+    [[nodiscard]] SkipList<T, Indexable, Stats, Compare> thaw() const;
+
+private:
+    Compare comp;
+    snapshot::Array<T> keys;
+    snapshot::Array<uint8_t> levels;
 };
 
-#endif 
\ No newline at end of file
+#endif
@@ -0,0 +1,133 @@
+#ifndef SKIP_MAP_HPP
+#define SKIP_MAP_HPP
+
+// SkipList's member templates are defined in its .cpp
+#include "SkipList.cpp"
+
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+// Ordered map from K to V on a SkipList of std::pair<const K, V> ordered
+// by key, so a key is stored once and looked up without building a pair.
+// Iteration yields the pairs in key order; values are changed through
+// find(), at(), operator[] or insert_or_assign(). With a transparent
+// Compare the lookups also take any key type it can compare with K.
+template<typename K, typename V, class Compare = std::less<K>>
+class SkipMap {
+public:
+    using value_type = std::pair<const K, V>;
+
+private:
+    // Orders pairs by key and compares pairs with bare keys
+    struct KeyCompare {
+        using is_transparent = void;
+        Compare comp;
+
+        bool operator()(const value_type& a, const value_type& b) const { return comp(a.first, b.first); }
+        template<typename Key>
+        bool operator()(const value_type& a, const Key& b) const { return comp(a.first, b); }
+        template<typename Key>
+        bool operator()(const Key& a, const value_type& b) const { return comp(a, b.first); }
+    };
+    using List = SkipList<value_type, false, stats::None, KeyCompare>;
+    template<typename C>
+    using if_transparent = typename C::is_transparent;
+
+    List list;
+
+    template<typename Key>
+    V* lookup(const Key& key) const {
+        auto node = list.first_not_less(key);
+        return list.holds(node, key) ? &node->value.second : nullptr;
+    }
+    template<typename Key, typename... Args>
+    std::pair<V*, bool> emplace_key(Key&& key, Args&&... args) {
+        // The pair is only built once the key is known to be missing
+        auto [node, inserted] = list.insert_with(key, [&]() -> value_type {
+            return value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+        });
+        return {&node->value.second, inserted};
+    }
+
+public:
+    using const_iterator = typename List::const_iterator;
+    using iterator = const_iterator;
+
+    SkipMap() : SkipMap(Compare()) {}
+    explicit SkipMap(const Compare& comp) : list(KeyCompare{comp}) {}
+
+    // Builds V from args unless key is present, in which case neither key
+    // nor args are touched. Returns the value for key and whether it is new.
+    template<typename... Args>
+    std::pair<V*, bool> try_emplace(const K& key, Args&&... args) {
+        return emplace_key(key, std::forward<Args>(args)...);
+    }
+    template<typename... Args>
+    std::pair<V*, bool> try_emplace(K&& key, Args&&... args) {
+        return emplace_key(std::move(key), std::forward<Args>(args)...);
+    }
+    // Inserts or overwrites; true if key is new.
+    template<typename M>
+    bool insert_or_assign(const K& key, M&& value) {
+        auto [slot, inserted] = try_emplace(key, std::forward<M>(value));
+        if (!inserted) *slot = std::forward<M>(value);
+        return inserted;
+    }
+    template<typename M>
+    bool insert_or_assign(K&& key, M&& value) {
+        auto [slot, inserted] = try_emplace(std::move(key), std::forward<M>(value));
+        if (!inserted) *slot = std::forward<M>(value);
+        return inserted;
+    }
+    // Value for key, value-initialized first if key is missing
+    V& operator[](const K& key) { return *try_emplace(key).first; }
+    V& operator[](K&& key) { return *try_emplace(std::move(key)).first; }
+
+    // Value for key, or nullptr
+    [[nodiscard]] V* find(const K& key) { return lookup(key); }
+    [[nodiscard]] const V* find(const K& key) const { return lookup(key); }
+    template<typename Key, typename C = Compare, typename = if_transparent<C>>
+    [[nodiscard]] V* find(const Key& key) { return lookup(key); }
+    template<typename Key, typename C = Compare, typename = if_transparent<C>>
+    [[nodiscard]] const V* find(const Key& key) const { return lookup(key); }
+    // Value for key; throws std::out_of_range if key is missing.
+    [[nodiscard]] V& at(const K& key) { return checked(lookup(key)); }
+    [[nodiscard]] const V& at(const K& key) const { return checked(lookup(key)); }
+    template<typename Key, typename C = Compare, typename = if_transparent<C>>
+    [[nodiscard]] V& at(const Key& key) { return checked(lookup(key)); }
+    template<typename Key, typename C = Compare, typename = if_transparent<C>>
+    [[nodiscard]] const V& at(const Key& key) const { return checked(lookup(key)); }
+
+    [[nodiscard]] bool contains(const K& key) const { return list.contains(key); }
+    template<typename Key, typename C = Compare, typename = if_transparent<C>>
+    [[nodiscard]] bool contains(const Key& key) const { return list.contains(key); }
+    // false if key was not present
+    bool remove(const K& key) { return list.remove(key); }
+    template<typename Key, typename C = Compare, typename = if_transparent<C>>
+    bool remove(const Key& key) { return list.remove(key); }
+
+    [[nodiscard]] bool empty() const { return list.empty(); }
+    [[nodiscard]] size_t size() const { return list.size(); }
+    void clear() { list.clear(); }
+
+    [[nodiscard]] const_iterator begin() const { return list.begin(); }
+    [[nodiscard]] const_iterator end() const { return list.end(); }
+    // First pair whose key is not less than (upper_bound: greater than) key
+    [[nodiscard]] const_iterator lower_bound(const K& key) const { return list.lower_bound(key); }
+    [[nodiscard]] const_iterator upper_bound(const K& key) const { return list.upper_bound(key); }
+    template<typename Key, typename C = Compare, typename = if_transparent<C>>
+    [[nodiscard]] const_iterator lower_bound(const Key& key) const { return list.lower_bound(key); }
+    template<typename Key, typename C = Compare, typename = if_transparent<C>>
+    [[nodiscard]] const_iterator upper_bound(const Key& key) const { return list.upper_bound(key); }
+
+private:
+    static V& checked(V* value) {
+        if (!value) throw std::out_of_range("SkipMap::at: key not found");
+        return *value;
+    }
+};
+
+#endif
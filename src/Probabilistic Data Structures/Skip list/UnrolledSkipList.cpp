@@ -0,0 +1,375 @@
+#include "UnrolledSkipList.hpp"
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+template<typename T, size_t BlockSize>
+typename UnrolledSkipList<T, BlockSize>::Block* UnrolledSkipList<T, BlockSize>::create_block(size_t level) {
+    void* p = ::operator new(Block::bytes(level), std::align_val_t(alignof(Block)));
+    Block* block = new (p) Block;
+    block->count = 0;
+    block->level = static_cast<uint32_t>(level);
+    for (size_t i = 0; i < level; i++) {
+        block->forward()[i] = nullptr;
+    }
+    pad(block);
+    bytes_allocated += Block::bytes(level);
+    return block;
+}
+
+template<typename T, size_t BlockSize>
+void UnrolledSkipList<T, BlockSize>::destroy_block(Block* block) {
+    bytes_allocated -= Block::bytes(block->level);
+    block->~Block();
+    ::operator delete(block, std::align_val_t(alignof(Block)));
+}
+
+template<typename T, size_t BlockSize>
+void UnrolledSkipList<T, BlockSize>::pad(Block* block) {
+    if constexpr (SIMD_KEYS) {
+        std::fill(block->keys + block->count, block->keys + BlockSize, std::numeric_limits<T>::max());
+    }
+}
+
+template<typename T, size_t BlockSize>
+UnrolledSkipList<T, BlockSize>::UnrolledSkipList()
+    : current_level(1)
+    , count(0)
+    , bytes_allocated(0)
+    , gen(std::random_device{}()) {
+    head = create_block(MAX_LEVEL);
+}
+
+template<typename T, size_t BlockSize>
+void UnrolledSkipList<T, BlockSize>::destroy_all() {
+    Block* current = head;
+    while (current) {
+        Block* next = current->forward()[0];
+        destroy_block(current);
+        current = next;
+    }
+    head = nullptr;
+}
+
+template<typename T, size_t BlockSize>
+UnrolledSkipList<T, BlockSize>::~UnrolledSkipList() {
+    destroy_all();
+}
+
+template<typename T, size_t BlockSize>
+UnrolledSkipList<T, BlockSize>::UnrolledSkipList(UnrolledSkipList&& other) : UnrolledSkipList() {
+    // other is left with the fresh head built here, so it stays usable
+    swap(other);
+}
+
+template<typename T, size_t BlockSize>
+UnrolledSkipList<T, BlockSize>& UnrolledSkipList<T, BlockSize>::operator=(UnrolledSkipList&& other) {
+    if (this != &other) {
+        UnrolledSkipList taken(std::move(other));
+        swap(taken);
+    }
+    return *this;
+}
+
+template<typename T, size_t BlockSize>
+void UnrolledSkipList<T, BlockSize>::swap(UnrolledSkipList& other) noexcept {
+    using std::swap;
+    swap(head, other.head);
+    swap(current_level, other.current_level);
+    swap(count, other.count);
+    swap(bytes_allocated, other.bytes_allocated);
+    swap(gen, other.gen);
+}
+
+template<typename T, size_t BlockSize>
+void UnrolledSkipList<T, BlockSize>::clear() {
+    Block* current = head->forward()[0];
+    while (current) {
+        Block* next = current->forward()[0];
+        destroy_block(current);
+        current = next;
+    }
+    for (size_t i = 0; i < MAX_LEVEL; i++) {
+        head->forward()[i] = nullptr;
+    }
+    current_level = 1;
+    count = 0;
+}
+
+template<typename T, size_t BlockSize>
+size_t UnrolledSkipList<T, BlockSize>::random_level() {
+    // Geometric with p = 1/2: one plus the trailing zeros of a random word.
+    uint64_t bits = gen() | (uint64_t(1) << (MAX_LEVEL - 1));
+    return 1 + static_cast<size_t>(__builtin_ctzll(bits));
+}
+
+template<typename T, size_t BlockSize>
+uint32_t UnrolledSkipList<T, BlockSize>::count_less(const Block* block, const T& value) {
+    if constexpr (SIMD_KEYS) {
+        // Padding holds the maximum, which is never below value, so all
+        // BlockSize lanes can be compared without looking at count.
+#if defined(__AVX2__)
+        unsigned total = 0;
+        if constexpr (sizeof(T) == 4) {
+            // Unsigned order is signed order with the top bit flipped.
+            const __m256i flip = _mm256_set1_epi32(std::is_signed_v<T> ? 0 : INT32_MIN);
+            const __m256i needle = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(value)), flip);
+            for (size_t i = 0; i < BlockSize; i += 8) {
+                __m256i keys = _mm256_load_si256(reinterpret_cast<const __m256i*>(block->keys + i));
+                __m256i less = _mm256_cmpgt_epi32(needle, _mm256_xor_si256(keys, flip));
+                total += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(less)));
+            }
+        } else {
+            const __m256i flip = _mm256_set1_epi64x(std::is_signed_v<T> ? 0 : INT64_MIN);
+            const __m256i needle = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(value)), flip);
+            for (size_t i = 0; i < BlockSize; i += 4) {
+                __m256i keys = _mm256_load_si256(reinterpret_cast<const __m256i*>(block->keys + i));
+                __m256i less = _mm256_cmpgt_epi64(needle, _mm256_xor_si256(keys, flip));
+                total += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+            }
+        }
+        return total;
+#else
+        // Branch-free so the compiler can vectorise it for the target.
+        unsigned total = 0;
+        for (size_t i = 0; i < BlockSize; i++) {
+            total += block->keys[i] < value;
+        }
+        return total;
+#endif
+    } else {
+        return static_cast<uint32_t>(std::lower_bound(block->keys, block->keys + block->count, value) - block->keys);
+    }
+}
+
+template<typename T, size_t BlockSize>
+typename UnrolledSkipList<T, BlockSize>::Block* UnrolledSkipList<T, BlockSize>::find_block(
+    const T& value, Block** update) const {
+    Block* current = head;
+    for (int i = current_level - 1; i >= 0; i--) {
+        while (current->forward()[i] && !(value < current->forward()[i]->keys[0])) {
+            current = current->forward()[i];
+        }
+        if (update) update[i] = current;
+    }
+    return current;
+}
+
+template<typename T, size_t BlockSize>
+void UnrolledSkipList<T, BlockSize>::find_preds(const T& key, Block** update) const {
+    Block* current = head;
+    for (int i = current_level - 1; i >= 0; i--) {
+        while (current->forward()[i] && current->forward()[i]->keys[0] < key) {
+            current = current->forward()[i];
+        }
+        update[i] = current;
+    }
+}
+
+template<typename T, size_t BlockSize>
+void UnrolledSkipList<T, BlockSize>::link_after(Block* block, Block** update) {
+    if (block->level > current_level) {
+        for (size_t i = current_level; i < block->level; i++) {
+            update[i] = head;
+        }
+        current_level = block->level;
+    }
+    for (size_t i = 0; i < block->level; i++) {
+        block->forward()[i] = update[i]->forward()[i];
+        update[i]->forward()[i] = block;
+    }
+}
+
+template<typename T, size_t BlockSize>
+void UnrolledSkipList<T, BlockSize>::unlink(Block* block, Block** update) {
+    for (size_t i = 0; i < block->level; i++) {
+        if (update[i]->forward()[i] == block) {
+            update[i]->forward()[i] = block->forward()[i];
+        }
+    }
+    while (current_level > 1 && !head->forward()[current_level - 1]) {
+        current_level--;
+    }
+}
+
+template<typename T, size_t BlockSize>
+bool UnrolledSkipList<T, BlockSize>::insert(const T& value) {
+    Block* update[MAX_LEVEL];
+    Block* block = find_block(value, update);
+    if (block == head) {
+        // value is below every block: it goes to the front of the first.
+        block = head->forward()[0];
+        if (!block) {
+            block = create_block(random_level());
+            block->keys[0] = value;
+            block->count = 1;
+            link_after(block, update);
+            count++;
+            return true;
+        }
+        for (size_t i = 0; i < block->level; i++) {
+            update[i] = block;
+        }
+    }
+    uint32_t pos = count_less(block, value);
+    if (pos < block->count && block->keys[pos] == value) {
+        return false;
+    }
+    if (block->count == BlockSize) {
+        constexpr uint32_t half = BlockSize / 2;
+        Block* upper = create_block(random_level());
+        std::copy(block->keys + half, block->keys + BlockSize, upper->keys);
+        upper->count = BlockSize - half;
+        block->count = half;
+        pad(block);
+        link_after(upper, update);
+        if (pos > half) {
+            block = upper;
+            pos -= half;
+        }
+    }
+    std::move_backward(block->keys + pos, block->keys + block->count, block->keys + block->count + 1);
+    block->keys[pos] = value;
+    block->count++;
+    count++;
+    return true;
+}
+
+template<typename T, size_t BlockSize>
+bool UnrolledSkipList<T, BlockSize>::remove(const T& value) {
+    Block* block = find_block(value, nullptr);
+    if (block == head) {
+        return false;
+    }
+    uint32_t pos = count_less(block, value);
+    if (pos >= block->count || block->keys[pos] != value) {
+        return false;
+    }
+    Block* update[MAX_LEVEL];
+    count--;
+    if (block->count == 1) {
+        find_preds(block->keys[0], update);
+        unlink(block, update);
+        destroy_block(block);
+        return true;
+    }
+    std::move(block->keys + pos + 1, block->keys + block->count, block->keys + pos);
+    block->count--;
+    pad(block);
+    Block* next = block->forward()[0];
+    if (next && block->count + next->count <= BlockSize / 2) {
+        std::copy(next->keys, next->keys + next->count, block->keys + block->count);
+        block->count += next->count;
+        find_preds(next->keys[0], update);
+        unlink(next, update);
+        destroy_block(next);
+    }
+    return true;
+}
+
+template<typename T, size_t BlockSize>
+bool UnrolledSkipList<T, BlockSize>::contains(const T& value) const {
+    const Block* block = find_block(value, nullptr);
+    if (block == head) {
+        return false;
+    }
+    uint32_t pos = count_less(block, value);
+    return pos < block->count && block->keys[pos] == value;
+}
+
+template<typename T, size_t BlockSize>
+std::optional<T> UnrolledSkipList<T, BlockSize>::find_min() const {
+    if (empty()) {
+        return std::nullopt;
+    }
+    return head->forward()[0]->keys[0];
+}
+
+template<typename T, size_t BlockSize>
+std::optional<T> UnrolledSkipList<T, BlockSize>::find_max() const {
+    if (empty()) {
+        return std::nullopt;
+    }
+    const Block* current = head;
+    for (int i = current_level - 1; i >= 0; i--) {
+        while (current->forward()[i]) {
+            current = current->forward()[i];
+        }
+    }
+    return current->keys[current->count - 1];
+}
+
+template<typename T, size_t BlockSize>
+template<typename InputIt>
+void UnrolledSkipList<T, BlockSize>::bulk_load(InputIt first, InputIt last) {
+    clear();
+    // Block k (1-based) gets 1 + ctz(k) levels, as in SkipList::bulk_load.
+    Block* tail[MAX_LEVEL];
+    std::fill(tail, tail + MAX_LEVEL, head);
+    Block* block = nullptr;
+    size_t blocks = 0;
+    for (; first != last; ++first) {
+        const T& value = *first;
+        if (block) {
+            const T& previous = block->keys[block->count - 1];
+            if (value == previous) continue;
+            if (value < previous) {
+                throw std::invalid_argument("UnrolledSkipList::bulk_load: input is not sorted");
+            }
+        }
+        if (!block || block->count == LOAD_FILL) {
+            size_t level = std::min<size_t>(1 + __builtin_ctzll(++blocks), MAX_LEVEL);
+            block = create_block(level);
+            for (size_t i = 0; i < level; i++) {
+                tail[i]->forward()[i] = block;
+                tail[i] = block;
+            }
+            current_level = std::max(current_level, level);
+        }
+        block->keys[block->count++] = value;
+        count++;
+    }
+}
+
+template<typename T, size_t BlockSize>
+typename UnrolledSkipList<T, BlockSize>::const_iterator UnrolledSkipList<T, BlockSize>::lower_bound(
+    const T& value) const {
+    const Block* block = find_block(value, nullptr);
+    if (block == head) {
+        return begin();
+    }
+    uint32_t pos = count_less(block, value);
+    if (pos == block->count) {
+        return const_iterator(block->forward()[0], 0);
+    }
+    return const_iterator(block, pos);
+}
+
+template<typename T, size_t BlockSize>
+typename UnrolledSkipList<T, BlockSize>::const_iterator UnrolledSkipList<T, BlockSize>::upper_bound(
+    const T& value) const {
+    const Block* block = find_block(value, nullptr);
+    if (block == head) {
+        return begin();
+    }
+    auto pos = static_cast<uint32_t>(std::upper_bound(block->keys, block->keys + block->count, value) - block->keys);
+    if (pos == block->count) {
+        return const_iterator(block->forward()[0], 0);
+    }
+    return const_iterator(block, pos);
+}
+
+template<typename T, size_t BlockSize>
+std::vector<T> UnrolledSkipList<T, BlockSize>::range(const T& start, const T& end) const {
+    std::vector<T> result;
+    for (auto it = lower_bound(start); it != this->end() && *it <= end; ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
@@ -0,0 +1,141 @@
+#ifndef UNROLLED_SKIP_LIST_HPP
+#define UNROLLED_SKIP_LIST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+// Sorted set with the SkipList<T> interface whose nodes are blocks of up to
+// BlockSize keys (a B-skiplist). The towers index blocks by their smallest
+// key, so a search walks the towers to one block and finishes inside it;
+// level 0 visits n / BlockSize nodes instead of n. A full block splits in
+// half on insert; a block that empties is unlinked and two neighbours that
+// would fit in half a block are merged.
+//
+// For 32- and 64-bit integer T the keys of a block are padded to BlockSize
+// with the maximum value and searched by counting lanes below the probe,
+// with AVX2 compares when available. Other types binary search the block.
+template<typename T, size_t BlockSize = 32>
+class UnrolledSkipList {
+    static_assert(BlockSize >= 16 && BlockSize <= 64 && BlockSize % 8 == 0,
+                  "BlockSize must be a multiple of 8 between 16 and 64");
+
+private:
+    static constexpr bool SIMD_KEYS = std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                      (sizeof(T) == 4 || sizeof(T) == 8);
+
+    // keys[0, count) sorted, followed by `level` forward pointers.
+    struct Block {
+        alignas(32) T keys[BlockSize];
+        uint32_t count;
+        uint32_t level;
+
+        Block** forward() { return reinterpret_cast<Block**>(this + 1); }
+        Block* const* forward() const { return reinterpret_cast<Block* const*>(this + 1); }
+        static size_t bytes(size_t level) { return sizeof(Block) + level * sizeof(Block*); }
+    };
+    static_assert(sizeof(Block) % alignof(Block*) == 0, "tower must follow the header aligned");
+
+    // Enough for 2^24 blocks, several hundred million keys.
+    static constexpr size_t MAX_LEVEL = 24;
+    // bulk_load leaves room for a quarter of a block of inserts.
+    static constexpr size_t LOAD_FILL = BlockSize * 3 / 4;
+    Block* head;
+    size_t current_level;
+    size_t count;
+    size_t bytes_allocated;
+    std::mt19937_64 gen;
+
+    [[nodiscard]] size_t random_level();
+    [[nodiscard]] Block* create_block(size_t level);
+    void destroy_block(Block* block);
+    void destroy_all();
+    void swap(UnrolledSkipList& other) noexcept;
+    static void pad(Block* block);
+    // Number of keys in the block less than value.
+    [[nodiscard]] static uint32_t count_less(const Block* block, const T& value);
+    // Last block whose smallest key is not greater than value; head if none.
+    // update, when given, receives that block's counterpart on every level.
+    [[nodiscard]] Block* find_block(const T& value, Block** update) const;
+    // Predecessors on every level of the block whose smallest key is key.
+    void find_preds(const T& key, Block** update) const;
+    void unlink(Block* block, Block** update);
+    void link_after(Block* block, Block** update);
+
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+        reference operator*() const { return block->keys[index]; }
+        pointer operator->() const { return &block->keys[index]; }
+        const_iterator& operator++() {
+            if (++index == block->count) {
+                block = block->forward()[0];
+                index = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        friend bool operator==(const const_iterator& a, const const_iterator& b) {
+            return a.block == b.block && a.index == b.index;
+        }
+        friend bool operator!=(const const_iterator& a, const const_iterator& b) { return !(a == b); }
+
+    private:
+        friend class UnrolledSkipList;
+        const_iterator(const Block* block, uint32_t index) : block(block), index(index) {}
+        const Block* block = nullptr;
+        uint32_t index = 0;
+    };
+    using iterator = const_iterator;
+
+    UnrolledSkipList();
+    ~UnrolledSkipList();
+    // no copying!!!
+    UnrolledSkipList(const UnrolledSkipList&) = delete;
+    UnrolledSkipList& operator=(const UnrolledSkipList&) = delete;
+    //  moving; other is left empty and can be used again, which costs it
+    // a fresh head block
+    UnrolledSkipList(UnrolledSkipList&& other);
+    UnrolledSkipList& operator=(UnrolledSkipList&& other);
+    // Core
+    [[nodiscard]] bool insert(const T& value);
+    [[nodiscard]] bool remove(const T& value);
+    [[nodiscard]] bool contains(const T& value) const;
+    // Utility
+    [[nodiscard]] bool empty() const { return count == 0; }
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] std::optional<T> find_min() const;
+    [[nodiscard]] std::optional<T> find_max() const;
+    [[nodiscard]] size_t memory_usage() const { return bytes_allocated; }
+    void clear();
+    // Replaces the contents with the ascending sequence [first, last), three
+    // quarters filling each block. Repeated values are skipped; throws
+    // std::invalid_argument if a value is out of order.
+    template<typename InputIt>
+    void bulk_load(InputIt first, InputIt last);
+    // Iteration
+    [[nodiscard]] const_iterator begin() const { return const_iterator(head->forward()[0], 0); }
+    [[nodiscard]] const_iterator end() const { return const_iterator(nullptr, 0); }
+    [[nodiscard]] const_iterator lower_bound(const T& value) const;
+    [[nodiscard]] const_iterator upper_bound(const T& value) const;
+    // Range operations
+    [[nodiscard]] std::vector<T> range(const T& start, const T& end) const;
+};
+
+#endif
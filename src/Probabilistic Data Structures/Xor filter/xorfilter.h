@@ -0,0 +1,310 @@
+#ifndef XORFILTER_H
+#define XORFILTER_H
+
+#include "../snapshot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace xorfilter {
+
+// 3-wise binary fuse filter (Graf & Lemire, "Binary Fuse Filters: Fast and
+// Smaller Than Xor Filters"). The filter is built once from a fixed key set
+// and cannot be updated. A key is present when the xor of the three
+// fingerprints at its three positions equals its own fingerprint; the three
+// positions fall in three consecutive segments of the table, which keeps
+// construction cache friendly.
+//
+// With 8-bit fingerprints it uses about 9 bits per key for a 0.39% false
+// positive rate; 16-bit fingerprints give about 18 bits per key and 0.0015%.
+template<class Fingerprint = uint8_t>
+class BinaryFuseFilter {
+    static_assert(std::is_same_v<Fingerprint, uint8_t> || std::is_same_v<Fingerprint, uint16_t>,
+                  "fingerprints must be uint8_t or uint16_t");
+
+public:
+    static constexpr int MAX_ITERATIONS = 100;
+
+    // Duplicate keys are allowed and counted once. Throws std::length_error
+    // for 2^32 or more keys and std::runtime_error if no seed works, which
+    // only happens with a broken hash.
+    BinaryFuseFilter(const uint64_t* keys, size_t n);
+    explicit BinaryFuseFilter(const std::vector<uint64_t>& keys)
+        : BinaryFuseFilter(keys.data(), keys.size()) {}
+
+    [[nodiscard]] bool contains(uint64_t key) const;
+
+    [[nodiscard]] size_t size() const { return key_count; }
+    [[nodiscard]] size_t size_in_bytes() const { return fingerprints.size() * sizeof(Fingerprint); }
+
+    // Snapshots of the raw fingerprint array (see snapshot.h); a loaded
+    // filter queries the mapped file in place.
+    void save(const std::string& path) const;
+    [[nodiscard]] static std::unique_ptr<BinaryFuseFilter> load(const std::string& path);
+
+private:
+    static uint64_t murmur64(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+    static uint64_t splitmix64(uint64_t& state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    static uint64_t mulhi(uint64_t a, uint64_t b) {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+    }
+    static Fingerprint fingerprint(uint64_t hash) { return static_cast<Fingerprint>(hash ^ (hash >> 32)); }
+
+    explicit BinaryFuseFilter(snapshot::Reader& reader);
+
+    // Position of the index-th (0, 1 or 2) probe of hash.
+    [[nodiscard]] uint32_t position(uint32_t index, uint64_t hash) const;
+
+    // Returns false if this seed leaves a cycle among the keys; keys may be
+    // replaced by a deduplicated copy held in unique. On success n is the
+    // number of distinct keys.
+    bool populate(const uint64_t*& keys, uint32_t& n, std::vector<uint64_t>& unique);
+
+    uint64_t seed = 0;
+    uint32_t segment_length = 0;
+    uint32_t segment_length_mask = 0;
+    uint32_t segment_count = 0;
+    uint32_t segment_count_length = 0;
+    uint32_t array_length = 0;
+    size_t key_count = 0;
+    snapshot::Array<Fingerprint> fingerprints;
+};
+
+template<class Fingerprint>
+BinaryFuseFilter<Fingerprint>::BinaryFuseFilter(const uint64_t* keys, size_t n) : key_count(n) {
+    if (n >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("binary fuse filter supports fewer than 2^32 keys");
+    }
+    const uint32_t size = static_cast<uint32_t>(n);
+    const uint32_t arity = 3;
+
+    // Sizing rules from the reference implementation.
+    segment_length = size == 0 ? 4 : uint32_t(1) << static_cast<int>(std::floor(std::log(double(size)) / std::log(3.33) + 2.25));
+    segment_length = std::min<uint32_t>(segment_length, 262144);
+    segment_length_mask = segment_length - 1;
+    double size_factor = size <= 1 ? 0 : std::max(1.125, 0.875 + 0.25 * std::log(1000000.0) / std::log(double(size)));
+    uint32_t capacity = size <= 1 ? 0 : static_cast<uint32_t>(std::round(double(size) * size_factor));
+    // Unsigned wrap-around is intended for tiny inputs.
+    uint32_t init_segment_count = (capacity + segment_length - 1) / segment_length - (arity - 1);
+    array_length = (init_segment_count + arity - 1) * segment_length;
+    segment_count = (array_length + segment_length - 1) / segment_length;
+    segment_count = segment_count <= arity - 1 ? 1 : segment_count - (arity - 1);
+    array_length = (segment_count + arity - 1) * segment_length;
+    segment_count_length = segment_count * segment_length;
+    fingerprints = snapshot::Array<Fingerprint>(array_length);
+
+    uint64_t rng = 0x726b2b9d438b9d4dULL;
+    std::vector<uint64_t> unique;
+    uint32_t count = size;
+    for (int iteration = 0; iteration < MAX_ITERATIONS; ++iteration) {
+        seed = splitmix64(rng);
+        if (populate(keys, count, unique)) {
+            key_count = count;
+            return;
+        }
+    }
+    throw std::runtime_error("binary fuse filter construction failed");
+}
+
+template<class Fingerprint>
+BinaryFuseFilter<Fingerprint>::BinaryFuseFilter(snapshot::Reader& reader)
+    : seed(reader.field(0))
+    , segment_length(static_cast<uint32_t>(reader.field(1)))
+    , segment_count(static_cast<uint32_t>(reader.field(2)))
+    , array_length(static_cast<uint32_t>(reader.field(3)))
+    , key_count(reader.field(4)) {
+    // Probes stay inside the array only if the geometry is consistent
+    if (segment_length == 0 || (segment_length & (segment_length - 1)) != 0 || segment_count == 0 ||
+        uint64_t(array_length) != (uint64_t(segment_count) + 2) * segment_length) {
+        reader.fail("inconsistent binary fuse filter geometry");
+    }
+    segment_length_mask = segment_length - 1;
+    segment_count_length = segment_count * segment_length;
+    fingerprints = reader.take<Fingerprint>(array_length);
+}
+
+template<class Fingerprint>
+void BinaryFuseFilter<Fingerprint>::save(const std::string& path) const {
+    snapshot::Writer out(path, snapshot::Kind::BINARY_FUSE, sizeof(Fingerprint),
+                         {seed, segment_length, segment_count, array_length, key_count});
+    out.section(fingerprints.data(), size_in_bytes());
+    out.commit();
+}
+
+template<class Fingerprint>
+std::unique_ptr<BinaryFuseFilter<Fingerprint>> BinaryFuseFilter<Fingerprint>::load(const std::string& path) {
+    snapshot::Reader reader(path, snapshot::Kind::BINARY_FUSE, sizeof(Fingerprint));
+    return std::unique_ptr<BinaryFuseFilter>(new BinaryFuseFilter(reader));
+}
+
+template<class Fingerprint>
+uint32_t BinaryFuseFilter<Fingerprint>::position(uint32_t index, uint64_t hash) const {
+    uint64_t h = mulhi(hash, segment_count_length) + uint64_t(index) * segment_length;
+    uint64_t hh = hash & ((uint64_t(1) << 36) - 1);
+    h ^= (hh >> (36 - 18 * index)) & segment_length_mask;
+    return static_cast<uint32_t>(h);
+}
+
+template<class Fingerprint>
+bool BinaryFuseFilter<Fingerprint>::populate(const uint64_t*& keys, uint32_t& n, std::vector<uint64_t>& unique) {
+    const uint32_t size = n;
+    std::vector<uint64_t> reverse_order(size + 1, 0);
+    reverse_order[size] = 1;  // Sentinel for the bucketing scan below
+    std::vector<uint8_t> reverse_h(size);
+    std::vector<uint32_t> alone(array_length);
+    // t2count holds 4 * (keys at this slot) plus the xor of their probe
+    // indices; t2hash holds the xor of their hashes. A slot with one key
+    // therefore names the key and which of its probes lands here.
+    std::vector<uint8_t> t2count(array_length, 0);
+    std::vector<uint64_t> t2hash(array_length, 0);
+
+    // Order the hashes roughly by segment so the peeling pass below walks
+    // the table sequentially.
+    uint32_t block_bits = 1;
+    while ((uint32_t(1) << block_bits) < segment_count) ++block_bits;
+    const uint32_t block = uint32_t(1) << block_bits;
+    std::vector<uint32_t> start_pos(block);
+    for (uint32_t i = 0; i < block; ++i) {
+        start_pos[i] = static_cast<uint32_t>((uint64_t(i) * size) >> block_bits);
+    }
+    for (uint32_t i = 0; i < size; ++i) {
+        uint64_t hash = murmur64(keys[i] + seed);
+        uint32_t segment = static_cast<uint32_t>(hash >> (64 - block_bits));
+        while (reverse_order[start_pos[segment]] != 0) {
+            segment = (segment + 1) & (block - 1);
+        }
+        reverse_order[start_pos[segment]] = hash;
+        start_pos[segment]++;
+    }
+
+    bool error = false;
+    uint32_t duplicates = 0;
+    for (uint32_t i = 0; i < size; ++i) {
+        uint64_t hash = reverse_order[i];
+        uint32_t h0 = position(0, hash), h1 = position(1, hash), h2 = position(2, hash);
+        t2count[h0] += 4;
+        t2hash[h0] ^= hash;
+        t2count[h1] += 4;
+        t2count[h1] ^= 1;
+        t2hash[h1] ^= hash;
+        t2count[h2] += 4;
+        t2count[h2] ^= 2;
+        t2hash[h2] ^= hash;
+        // A second copy of a key cancels its hash out of all three slots.
+        if ((t2hash[h0] & t2hash[h1] & t2hash[h2]) == 0) {
+            if ((t2hash[h0] == 0 && t2count[h0] == 8) || (t2hash[h1] == 0 && t2count[h1] == 8) ||
+                (t2hash[h2] == 0 && t2count[h2] == 8)) {
+                duplicates++;
+                t2count[h0] -= 4;
+                t2hash[h0] ^= hash;
+                t2count[h1] -= 4;
+                t2count[h1] ^= 1;
+                t2hash[h1] ^= hash;
+                t2count[h2] -= 4;
+                t2count[h2] ^= 2;
+                t2hash[h2] ^= hash;
+            }
+        }
+        // The 6-bit key count wrapped around.
+        error = error || t2count[h0] < 4 || t2count[h1] < 4 || t2count[h2] < 4;
+    }
+    if (error) return false;
+
+    // Peel: repeatedly take a slot holding a single key, record it and
+    // remove the key from its other two slots.
+    uint32_t queue_size = 0;
+    for (uint32_t i = 0; i < array_length; ++i) {
+        alone[queue_size] = i;
+        queue_size += (t2count[i] >> 2) == 1 ? 1 : 0;
+    }
+    uint32_t stack_size = 0;
+    while (queue_size > 0) {
+        uint32_t index = alone[--queue_size];
+        if ((t2count[index] >> 2) != 1) continue;
+        uint64_t hash = t2hash[index];
+        uint32_t h012[5];
+        h012[1] = position(1, hash);
+        h012[2] = position(2, hash);
+        h012[3] = position(0, hash);
+        h012[4] = h012[1];
+        uint8_t found = t2count[index] & 3;
+        reverse_h[stack_size] = found;
+        reverse_order[stack_size] = hash;
+        stack_size++;
+
+        for (uint8_t k = 1; k <= 2; ++k) {
+            uint32_t other = h012[found + k];
+            alone[queue_size] = other;
+            queue_size += (t2count[other] >> 2) == 2 ? 1 : 0;
+            t2count[other] -= 4;
+            t2count[other] ^= (found + k) % 3;
+            t2hash[other] ^= hash;
+        }
+    }
+
+    if (stack_size + duplicates != size) {
+        if (duplicates > 0) {
+            // Deduplicate once so the next seed only has to deal with cycles.
+            unique.assign(keys, keys + size);
+            std::sort(unique.begin(), unique.end());
+            unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+            keys = unique.data();
+            n = static_cast<uint32_t>(unique.size());
+        }
+        return false;
+    }
+
+    // Assign fingerprints in reverse peeling order; each key's slot is the
+    // last of its three to be written.
+    for (uint32_t i = stack_size; i-- > 0;) {
+        uint64_t hash = reverse_order[i];
+        uint8_t found = reverse_h[i];
+        uint32_t h012[5];
+        h012[0] = position(0, hash);
+        h012[1] = position(1, hash);
+        h012[2] = position(2, hash);
+        h012[3] = h012[0];
+        h012[4] = h012[1];
+        fingerprints[h012[found]] = fingerprint(hash) ^ fingerprints[h012[found + 1]] ^ fingerprints[h012[found + 2]];
+    }
+    // Every distinct key was peeled exactly once; murmur64 is a bijection,
+    // so distinct keys never share a hash.
+    n = stack_size;
+    return true;
+}
+
+template<class Fingerprint>
+bool BinaryFuseFilter<Fingerprint>::contains(uint64_t key) const {
+    uint64_t hash = murmur64(key + seed);
+    uint32_t h0 = static_cast<uint32_t>(mulhi(hash, segment_count_length));
+    uint32_t h1 = h0 + segment_length;
+    uint32_t h2 = h1 + segment_length;
+    h1 ^= static_cast<uint32_t>(hash >> 18) & segment_length_mask;
+    h2 ^= static_cast<uint32_t>(hash) & segment_length_mask;
+    Fingerprint f = fingerprint(hash) ^ fingerprints[h0] ^ fingerprints[h1] ^ fingerprints[h2];
+    return f == 0;
+}
+
+} // namespace xorfilter
+
+#endif // XORFILTER_H
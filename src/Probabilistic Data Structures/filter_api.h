@@ -0,0 +1,193 @@
+#ifndef FILTER_API_H
+#define FILTER_API_H
+
+#include "Bloom filter/bloom.h"
+#include "Cuckoo filter/cuckoo.h"
+#include "Quotient filter/vqf.h"
+#include "Xor filter/xorfilter.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace filter {
+
+// Common face over the approximate membership filters, resolved at compile
+// time so generic code (benchmarks, the disk store guard) pays no virtual
+// call per query. Every specialization of FilterAPI<Table> provides
+//
+//   static constexpr bool DYNAMIC              insert() after construction
+//   static constexpr bool SUPPORTS_REMOVE      remove() is available
+//   static const char* name()
+//   static std::unique_ptr<Table> build(const uint64_t* keys, size_t n)
+//       a filter holding keys; nullptr if a dynamic filter ran full
+//   static bool contains(const Table&, uint64_t key)
+//   static void contains_batch(const Table&, const uint64_t* keys, size_t n, uint8_t* out)
+//   static FilterStats stats(const Table&)
+//   static void save(const Table&, const std::string& path)
+//   static std::unique_ptr<Table> load(const std::string& path)
+//       snapshots that load by mapping the file (see snapshot.h)
+//
+// and, for dynamic filters,
+//
+//   static std::unique_ptr<Table> construct(size_t capacity)
+//   static bool insert(Table&, uint64_t key)
+//   static bool remove(Table&, uint64_t key)   when SUPPORTS_REMOVE
+template<class Table>
+struct FilterAPI;
+
+// Snapshot returned by FilterAPI<Table>::stats(). Fields a filter does not
+// track are zero: only a cuckoo filter counted with stats::Count records
+// inserts and kicks, and a Bloom filter does not know its key count.
+struct FilterStats {
+    size_t keys = 0;
+    size_t bytes = 0;
+    // Occupied slots over all slots; for a Bloom filter the fraction of
+    // bits set
+    double load_factor = 0;
+    uint64_t inserts = 0;
+    uint64_t kicks = 0;
+
+    [[nodiscard]] double kicks_per_insert() const {
+        return inserts == 0 ? 0.0 : static_cast<double>(kicks) / inserts;
+    }
+};
+
+namespace detail {
+
+// Shared pieces for filters without specialised bulk paths.
+template<class Table>
+struct DefaultBatch {
+    static void contains_batch(const Table& table, const uint64_t* keys, size_t n, uint8_t* out) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = table.contains(keys[i]);
+        }
+    }
+};
+
+template<class Table>
+struct Snapshots {
+    static void save(const Table& table, const std::string& path) { table.save(path); }
+    static std::unique_ptr<Table> load(const std::string& path) { return Table::load(path); }
+};
+
+template<class Table>
+struct DynamicBuild {
+    static std::unique_ptr<Table> build(const uint64_t* keys, size_t n) {
+        auto table = std::make_unique<Table>(n);
+        for (size_t i = 0; i < n; ++i) {
+            if (!table->insert(keys[i])) return nullptr;
+        }
+        return table;
+    }
+};
+
+} // namespace detail
+
+template<>
+struct FilterAPI<bloom::BloomFilter> : detail::Snapshots<bloom::BloomFilter> {
+    static constexpr bool DYNAMIC = true;
+    static constexpr bool SUPPORTS_REMOVE = false;
+    static const char* name() { return "BlockedBloom"; }
+
+    static std::unique_ptr<bloom::BloomFilter> construct(size_t capacity) {
+        return std::make_unique<bloom::BloomFilter>(capacity);
+    }
+    static std::unique_ptr<bloom::BloomFilter> build(const uint64_t* keys, size_t n) {
+        auto table = construct(n);
+        table->insert_batch(keys, n);
+        return table;
+    }
+    static bool insert(bloom::BloomFilter& table, uint64_t key) {
+        table.insert(key);
+        return true;
+    }
+    static bool contains(const bloom::BloomFilter& table, uint64_t key) { return table.contains(key); }
+    static void contains_batch(const bloom::BloomFilter& table, const uint64_t* keys, size_t n, uint8_t* out) {
+        table.contains_batch(keys, n, out);
+    }
+    static FilterStats stats(const bloom::BloomFilter& table) {
+        FilterStats s;
+        s.bytes = table.size_in_bytes();
+        s.load_factor = table.fill_ratio();
+        return s;
+    }
+};
+
+template<unsigned FingerprintBits, class Stats>
+struct FilterAPI<cuckoo::CuckooFilter<FingerprintBits, Stats>>
+    : detail::DefaultBatch<cuckoo::CuckooFilter<FingerprintBits, Stats>>
+    , detail::DynamicBuild<cuckoo::CuckooFilter<FingerprintBits, Stats>>
+    , detail::Snapshots<cuckoo::CuckooFilter<FingerprintBits, Stats>> {
+    using Table = cuckoo::CuckooFilter<FingerprintBits, Stats>;
+    static constexpr bool DYNAMIC = true;
+    static constexpr bool SUPPORTS_REMOVE = true;
+    static const char* name() {
+        return FingerprintBits == 8 ? "Cuckoo8" : FingerprintBits == 12 ? "Cuckoo12" : "Cuckoo16";
+    }
+
+    static std::unique_ptr<Table> construct(size_t capacity) { return std::make_unique<Table>(capacity); }
+    static bool insert(Table& table, uint64_t key) { return table.insert(key); }
+    static bool contains(const Table& table, uint64_t key) { return table.contains(key); }
+    static bool remove(Table& table, uint64_t key) { return table.remove(key); }
+    static FilterStats stats(const Table& table) {
+        cuckoo::CuckooStats counted = table.stats();
+        FilterStats s;
+        s.keys = table.size();
+        s.bytes = table.size_in_bytes();
+        s.load_factor = counted.load_factor;
+        s.inserts = counted.inserts;
+        s.kicks = counted.kicks;
+        return s;
+    }
+};
+
+template<>
+struct FilterAPI<vqf::VectorQuotientFilter>
+    : detail::DefaultBatch<vqf::VectorQuotientFilter>
+    , detail::DynamicBuild<vqf::VectorQuotientFilter>
+    , detail::Snapshots<vqf::VectorQuotientFilter> {
+    using Table = vqf::VectorQuotientFilter;
+    static constexpr bool DYNAMIC = true;
+    static constexpr bool SUPPORTS_REMOVE = true;
+    static const char* name() { return "VQF8"; }
+
+    static std::unique_ptr<Table> construct(size_t capacity) { return std::make_unique<Table>(capacity); }
+    static bool insert(Table& table, uint64_t key) { return table.insert(key); }
+    static bool contains(const Table& table, uint64_t key) { return table.contains(key); }
+    static bool remove(Table& table, uint64_t key) { return table.remove(key); }
+    static FilterStats stats(const Table& table) {
+        FilterStats s;
+        s.keys = table.size();
+        s.bytes = table.size_in_bytes();
+        s.load_factor = table.load_factor();
+        return s;
+    }
+};
+
+template<class Fingerprint>
+struct FilterAPI<xorfilter::BinaryFuseFilter<Fingerprint>>
+    : detail::DefaultBatch<xorfilter::BinaryFuseFilter<Fingerprint>>
+    , detail::Snapshots<xorfilter::BinaryFuseFilter<Fingerprint>> {
+    using Table = xorfilter::BinaryFuseFilter<Fingerprint>;
+    static constexpr bool DYNAMIC = false;
+    static constexpr bool SUPPORTS_REMOVE = false;
+    static const char* name() { return sizeof(Fingerprint) == 1 ? "BinaryFuse8" : "BinaryFuse16"; }
+
+    static std::unique_ptr<Table> build(const uint64_t* keys, size_t n) {
+        return std::make_unique<Table>(keys, n);
+    }
+    static bool contains(const Table& table, uint64_t key) { return table.contains(key); }
+    static FilterStats stats(const Table& table) {
+        FilterStats s;
+        s.keys = table.size();
+        s.bytes = table.size_in_bytes();
+        s.load_factor = static_cast<double>(table.size()) / (table.size_in_bytes() / sizeof(Fingerprint));
+        return s;
+    }
+};
+
+} // namespace filter
+
+#endif // FILTER_API_H
@@ -0,0 +1,238 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace snapshot {
+
+// On-disk snapshots of the skip list and the filters, laid out so a mapped
+// file can be used in place. A file is a 64-byte Header followed by the
+// structure's arrays, each starting on a 64-byte boundary, in host byte
+// order; a file written on a machine of the other byte order is rejected.
+//
+// Files are mapped copy-on-write (MAP_PRIVATE): a loaded filter answers
+// queries straight from the page cache, and the kernel copies a page into
+// private memory only when an insert or remove first writes to it. Neither
+// side ever sees the other's changes as long as the file is replaced rather
+// than rewritten in place, which is what Writer does.
+constexpr char MAGIC[8] = {'P', 'D', 'S', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t ORDER_MARK = 0x01020304;
+constexpr size_t ALIGNMENT = 64;
+
+enum class Kind : uint32_t {
+    SKIP_LIST = 1,
+    BLOOM = 2,
+    CUCKOO = 3,
+    VECTOR_QUOTIENT = 4,
+    BINARY_FUSE = 5
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    Kind kind;
+    // Element size or fingerprint width, so a file cannot be loaded into
+    // an instantiation with a different layout
+    uint32_t variant;
+    uint32_t byte_order;
+    // Meaning depends on the kind
+    uint64_t fields[5];
+};
+static_assert(sizeof(Header) == ALIGNMENT, "the first array must start aligned");
+
+// Whole-file private mapping, readable and writable.
+class MappedFile {
+public:
+    // Throws std::runtime_error if the file cannot be mapped.
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("snapshot: cannot open " + path);
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("snapshot: cannot read " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        addr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) throw std::runtime_error("snapshot: cannot map " + path);
+    }
+    ~MappedFile() { ::munmap(addr, length); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    unsigned char* data() const { return static_cast<unsigned char*>(addr); }
+    size_t size() const { return length; }
+
+private:
+    void* addr;
+    size_t length;
+};
+
+// Fixed-size array that either owns its elements or lives inside a mapped
+// snapshot, which it keeps mapped. Owned elements start value-initialized.
+template<class T>
+class Array {
+public:
+    Array() = default;
+    explicit Array(size_t n) : owned(new T[n]()), items(owned.get()), length(n) {}
+    Array(std::shared_ptr<const MappedFile> file, T* items, size_t n)
+        : file(std::move(file)), items(items), length(n) {}
+    // Copies always own their elements
+    Array(const Array& other) : Array(other.length) { std::copy(other.begin(), other.end(), items); }
+    Array& operator=(const Array& other) {
+        if (this != &other) *this = Array(other);
+        return *this;
+    }
+    Array(Array&& other) noexcept
+        : owned(std::move(other.owned))
+        , file(std::move(other.file))
+        , items(std::exchange(other.items, nullptr))
+        , length(std::exchange(other.length, 0)) {}
+    Array& operator=(Array&& other) noexcept {
+        owned = std::move(other.owned);
+        file = std::move(other.file);
+        items = std::exchange(other.items, nullptr);
+        length = std::exchange(other.length, 0);
+        return *this;
+    }
+
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+    T* data() { return items; }
+    const T* data() const { return items; }
+    T* begin() { return items; }
+    T* end() { return items + length; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + length; }
+    [[nodiscard]] size_t size() const { return length; }
+    [[nodiscard]] bool mapped() const { return file != nullptr; }
+
+private:
+    std::unique_ptr<T[]> owned;
+    std::shared_ptr<const MappedFile> file;
+    T* items = nullptr;
+    size_t length = 0;
+};
+
+// Writes a snapshot to a temporary file next to path and renames it over
+// path in commit(), so readers never see a half written file and mappings
+// of the old file stay intact. Throws std::runtime_error on I/O errors.
+class Writer {
+public:
+    Writer(const std::string& path, Kind kind, uint32_t variant, std::initializer_list<uint64_t> fields)
+        : path(path), staging(path + ".tmp"), out(staging, std::ios::binary | std::ios::trunc) {
+        if (!out) throw std::runtime_error("snapshot: cannot create " + staging);
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.kind = kind;
+        header.variant = variant;
+        header.byte_order = ORDER_MARK;
+        if (fields.size() > sizeof(header.fields) / sizeof(header.fields[0])) {
+            throw std::logic_error("snapshot: too many header fields");
+        }
+        std::copy(fields.begin(), fields.end(), header.fields);
+        write(&header, sizeof(header));
+    }
+    ~Writer() {
+        if (!committed) std::remove(staging.c_str());
+    }
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // Appends bytes as the next array
+    void section(const void* data, size_t bytes) {
+        append(data, bytes);
+        end_section();
+    }
+    // The same in pieces: any number of append() calls, then end_section()
+    void append(const void* data, size_t bytes) { write(data, bytes); }
+    void end_section() {
+        static const char zeros[ALIGNMENT] = {};
+        write(zeros, (ALIGNMENT - written % ALIGNMENT) % ALIGNMENT);
+    }
+
+    void commit() {
+        out.close();
+        if (!out || std::rename(staging.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("snapshot: cannot write " + path);
+        }
+        committed = true;
+    }
+
+private:
+    void write(const void* data, size_t bytes) {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        if (!out) throw std::runtime_error("snapshot: cannot write " + staging);
+        written += bytes;
+    }
+
+    std::string path;
+    std::string staging;
+    std::ofstream out;
+    size_t written = 0;
+    bool committed = false;
+};
+
+// Maps a snapshot and hands out its arrays in the order they were written.
+// Throws std::runtime_error if the file cannot be mapped and
+// std::invalid_argument if it is not a snapshot of the expected kind and
+// variant, or is truncated.
+class Reader {
+public:
+    Reader(const std::string& path, Kind kind, uint32_t variant)
+        : path(path), file(std::make_shared<const MappedFile>(path)) {
+        if (file->size() < sizeof(Header)) fail("truncated");
+        std::memcpy(&head, file->data(), sizeof(Header));
+        if (std::memcmp(head.magic, MAGIC, sizeof(MAGIC)) != 0) fail("not a snapshot");
+        if (head.byte_order != ORDER_MARK) fail("written with the other byte order");
+        if (head.version != VERSION) fail("unsupported version " + std::to_string(head.version));
+        if (head.kind != kind) fail("snapshot of another structure");
+        if (head.variant != variant) fail("snapshot of another element or fingerprint size");
+    }
+
+    [[nodiscard]] uint64_t field(size_t i) const { return head.fields[i]; }
+
+    // The next n elements of type T, in place
+    template<class T>
+    Array<T> take(size_t n) {
+        static_assert(alignof(T) <= ALIGNMENT, "array elements must fit the section alignment");
+        if (n > (file->size() - offset) / sizeof(T)) fail("truncated");
+        T* items = reinterpret_cast<T*>(file->data() + offset);
+        size_t bytes = n * sizeof(T);
+        offset += bytes + (ALIGNMENT - bytes % ALIGNMENT) % ALIGNMENT;
+        offset = std::min(offset, file->size());
+        return Array<T>(file, items, n);
+    }
+
+    [[noreturn]] void fail(const std::string& reason) const {
+        throw std::invalid_argument("snapshot: " + path + ": " + reason);
+    }
+
+private:
+    std::string path;
+    std::shared_ptr<const MappedFile> file;
+    Header head;
+    size_t offset = sizeof(Header);
+};
+
+} // namespace snapshot
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,49 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+namespace stats {
+
+// Compile-time switch for the instrumentation of the structures that take a
+// Stats parameter (SkipList, CuckooFilter, the kinetic heater and hanger).
+// With None, the default, the counters are an empty type and every update
+// compiles away together with the values it would have recorded; Count
+// keeps the structure's snapshot struct and updates it in place, and
+// stats() hands out a copy.
+//
+// Lookups on a counted instance write to its counters, so a counted
+// instance must not be read from several threads at once.
+struct None {};
+struct Count {};
+
+template<class Policy, class Snapshot>
+class Counters;
+
+template<class Snapshot>
+class Counters<None, Snapshot> {
+public:
+    static constexpr bool ENABLED = false;
+
+    template<class Update>
+    void update(Update&&) const {}
+    Snapshot snapshot() const { return Snapshot{}; }
+    void reset() {}
+};
+
+template<class Snapshot>
+class Counters<Count, Snapshot> {
+public:
+    static constexpr bool ENABLED = true;
+
+    // Calls apply(Snapshot&); may be used from const member functions.
+    template<class Update>
+    void update(Update&& apply) const { apply(values); }
+    Snapshot snapshot() const { return values; }
+    void reset() { values = Snapshot{}; }
+
+private:
+    mutable Snapshot values{};
+};
+
+} // namespace stats
+
+#endif // STATS_HPP
@@ -0,0 +1,196 @@
+// Filter benchmark in the style of fastfilter_cpp's bulk-insert-and-query.
+//
+//   ./bench.exe <keys> [--csv] [filter names...]
+//
+// For every filter it reports the build (or insert) rate, single-key and
+// batched lookup rates for keys in the set and for keys not in it, bits per
+// key and the measured false positive rate. With --csv one comma separated
+// row is printed per filter instead of the table.
+
+#include "filter_api.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Keys {
+    std::vector<uint64_t> positive;
+    std::vector<uint64_t> negative;
+};
+
+struct Result {
+    const char* name;
+    double build_seconds;
+    double insert_mops;     // 0 for static filters
+    double positive_mops;
+    double negative_mops;
+    double batch_mops;      // contains_batch over a 50/50 mix
+    double bits_per_key;
+    double fpr;
+    bool full;
+};
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+Keys make_keys(size_t n) {
+    // Random 64-bit keys; a collision between the two sets is vanishingly
+    // unlikely and would only inflate the measured FPR by 1/n.
+    Keys keys;
+    uint64_t state = 0x1234567;
+    keys.positive.resize(n);
+    keys.negative.resize(n);
+    for (auto& k : keys.positive) k = splitmix64(state);
+    for (auto& k : keys.negative) k = splitmix64(state);
+    return keys;
+}
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double mops(size_t n, double seconds) {
+    return seconds > 0 ? static_cast<double>(n) / seconds / 1e6 : 0;
+}
+
+template<class Table>
+Result run(const Keys& keys) {
+    using API = filter::FilterAPI<Table>;
+    const size_t n = keys.positive.size();
+    Result r{};
+    r.name = API::name();
+
+    // Dynamic filters are timed inserting one key at a time, static ones
+    // on their bulk build; either way the build time includes allocation.
+    std::unique_ptr<Table> table;
+    Clock::time_point start = Clock::now();
+    if constexpr (API::DYNAMIC) {
+        table = API::construct(n);
+        Clock::time_point inserts = Clock::now();
+        for (uint64_t k : keys.positive) {
+            if (!API::insert(*table, k)) {
+                r.full = true;
+                return r;
+            }
+        }
+        r.insert_mops = mops(n, seconds_since(inserts));
+    } else {
+        table = API::build(keys.positive.data(), n);
+    }
+    r.build_seconds = seconds_since(start);
+
+    size_t hits = 0;
+    start = Clock::now();
+    for (uint64_t k : keys.positive) hits += API::contains(*table, k);
+    r.positive_mops = mops(n, seconds_since(start));
+    if (hits != n) {
+        std::fprintf(stderr, "%s: %zu false negatives\n", r.name, n - hits);
+    }
+
+    size_t false_hits = 0;
+    start = Clock::now();
+    for (uint64_t k : keys.negative) false_hits += API::contains(*table, k);
+    r.negative_mops = mops(n, seconds_since(start));
+    r.fpr = static_cast<double>(false_hits) / n;
+
+    std::vector<uint64_t> mixed(n);
+    for (size_t i = 0; i < n; ++i) {
+        mixed[i] = (i & 1) ? keys.negative[i] : keys.positive[i];
+    }
+    std::vector<uint8_t> out(n);
+    start = Clock::now();
+    API::contains_batch(*table, mixed.data(), n, out.data());
+    r.batch_mops = mops(n, seconds_since(start));
+
+    r.bits_per_key = 8.0 * table->size_in_bytes() / n;
+    return r;
+}
+
+void print_header(bool csv) {
+    if (csv) {
+        std::printf("filter,keys,build_s,insert_mops,positive_mops,negative_mops,batch_mops,bits_per_key,fpr\n");
+    } else {
+        std::printf("%-14s %9s %10s %10s %10s %10s %9s %9s\n", "filter", "build s", "insert", "find+",
+                    "find-", "batch", "bits/key", "FPR %");
+    }
+}
+
+void print_result(const Result& r, size_t n, bool csv) {
+    if (r.full) {
+        if (!csv) std::printf("%-14s construction failed\n", r.name);
+        return;
+    }
+    if (csv) {
+        std::printf("%s,%zu,%.4f,%.2f,%.2f,%.2f,%.2f,%.3f,%.6f\n", r.name, n, r.build_seconds, r.insert_mops,
+                    r.positive_mops, r.negative_mops, r.batch_mops, r.bits_per_key, r.fpr);
+    } else {
+        std::printf("%-14s %9.3f %10.2f %10.2f %10.2f %10.2f %9.2f %9.4f\n", r.name, r.build_seconds,
+                    r.insert_mops, r.positive_mops, r.negative_mops, r.batch_mops, r.bits_per_key, 100 * r.fpr);
+    }
+    std::fflush(stdout);
+}
+
+bool wanted(const std::vector<std::string>& names, const char* name) {
+    return names.empty() || std::find(names.begin(), names.end(), name) != names.end();
+}
+
+template<class T>
+struct Type {
+    using type = T;
+};
+
+template<class... Tables>
+void run_all(const Keys& keys, const std::vector<std::string>& names, bool csv) {
+    auto one = [&](auto tag) {
+        using Table = typename decltype(tag)::type;
+        if (wanted(names, filter::FilterAPI<Table>::name())) {
+            print_result(run<Table>(keys), keys.positive.size(), csv);
+        }
+    };
+    (one(Type<Tables>{}), ...);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <keys> [--csv] [filter names...]\n", argv[0]);
+        return 1;
+    }
+    size_t n = std::strtoull(argv[1], nullptr, 10);
+    if (n == 0) {
+        std::fprintf(stderr, "number of keys must be positive\n");
+        return 1;
+    }
+    bool csv = false;
+    std::vector<std::string> names;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else {
+            names.emplace_back(argv[i]);
+        }
+    }
+
+    Keys keys = make_keys(n);
+    if (!csv) std::printf("%zu keys, rates in million operations per second\n", n);
+    print_header(csv);
+    run_all<bloom::BloomFilter,
+            cuckoo::CuckooFilter<8>, cuckoo::CuckooFilter<12>, cuckoo::CuckooFilter<16>,
+            vqf::VectorQuotientFilter,
+            xorfilter::BinaryFuseFilter<uint8_t>, xorfilter::BinaryFuseFilter<uint16_t>>(keys, names, csv);
+    return 0;
+}
@@ -0,0 +1,569 @@
+// google-benchmark suite for the skip list, the kinetic heater and hanger,
+// the Fenwick and segment trees and the Burrows-Wheeler transform.
+//
+//   ./gbench.exe [--max_elements=N] [--corpus=DIR] [benchmark flags...]
+//
+// Skip list cases run at 1K to --max_elements elements (default 100M) with
+// uniform, Zipfian and sorted keys; the kinetic cases stop at 1M. The
+// Fenwick and segment tree cases run over the same sizes of random metric
+// values, building on one thread and on every hardware thread. The BWT
+// cases run every regular file in DIR (e.g. the Silesia or Canterbury
+// corpus; $BENCH_CORPUS if the flag is absent) at several block sizes, or
+// synthetic text and random bytes when no corpus is given. Pass
+// --benchmark_out=FILE --benchmark_out_format=json for machine readable
+// results; "make gbench" does.
+
+#include "SkipList.cpp"
+#include "Kinetic Heater/kinetic_heater.hpp"
+#include "Kinetic Hanger/kinetic_hanger.hpp"
+#include "bwt.hpp"
+#include "fenwick_tree.hpp"
+#include "segment_tree.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using kinetic::KineticHanger;
+using kinetic::KineticHeater;
+
+constexpr uint64_t SEED = 0x1234567;
+constexpr size_t QUERIES = size_t(1) << 20;
+constexpr size_t RANGE_WIDTH = 100;
+constexpr int64_t MIN_ELEMENTS = 1000;
+constexpr int64_t MAX_KINETIC_ELEMENTS = 1000000;
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Bijective, so distinct ranks give distinct keys
+uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    return x ^ (x >> 33);
+}
+
+// Zipfian ranks in [0, items) by Gray et al.'s method, as in YCSB; rank 0
+// is the most popular. The constructor is O(items).
+class Zipfian {
+public:
+    explicit Zipfian(uint64_t items, double theta = 0.99) : items(items), theta(theta) {
+        double zeta2 = 1 + std::pow(0.5, theta);
+        for (uint64_t i = 1; i <= items; ++i) zetan += std::pow(static_cast<double>(i), -theta);
+        alpha = 1 / (1 - theta);
+        eta = (1 - std::pow(2.0 / items, 1 - theta)) / (1 - zeta2 / zetan);
+    }
+
+    uint64_t next(uint64_t& state) const {
+        double u = static_cast<double>(splitmix64(state) >> 11) * 0x1.0p-53;
+        double uz = u * zetan;
+        if (uz < 1) return 0;
+        if (uz < 1 + std::pow(0.5, theta)) return 1;
+        auto rank = static_cast<uint64_t>(items * std::pow(eta * u - eta + 1, alpha));
+        return std::min(rank, items - 1);
+    }
+
+private:
+    uint64_t items;
+    double theta;
+    double zetan = 0;
+    double alpha;
+    double eta;
+};
+
+enum class Distribution { UNIFORM, ZIPFIAN, SORTED };
+
+const char* name_of(Distribution d) {
+    switch (d) {
+    case Distribution::UNIFORM: return "Uniform";
+    case Distribution::ZIPFIAN: return "Zipfian";
+    case Distribution::SORTED: return "Sorted";
+    }
+    return "";
+}
+
+// A list of n elements holds key_of(d, r) for every rank r in [0, n):
+// scattered over the key space unless the keys are sorted.
+uint64_t key_of(Distribution d, uint64_t rank) {
+    return d == Distribution::SORTED ? rank : mix64(rank);
+}
+
+// count ranks in [0, n) following d; sorted ranks ascend in even steps
+// over the whole range.
+std::vector<uint64_t> rank_stream(Distribution d, size_t n, size_t count) {
+    std::vector<uint64_t> ranks(count);
+    uint64_t state = SEED;
+    switch (d) {
+    case Distribution::UNIFORM:
+        for (auto& r : ranks) r = splitmix64(state) % n;
+        break;
+    case Distribution::ZIPFIAN: {
+        Zipfian zipf(n);
+        for (auto& r : ranks) r = zipf.next(state);
+        break;
+    }
+    case Distribution::SORTED:
+        for (size_t i = 0; i < count; ++i) ranks[i] = static_cast<uint64_t>(static_cast<double>(i) * n / count);
+        break;
+    }
+    return ranks;
+}
+
+// The keys the insert benchmark feeds in: every key once in scattered or
+// ascending order, or n Zipfian draws with the repeats that brings.
+const std::vector<uint64_t>& insert_stream(Distribution d, size_t n) {
+    static std::map<std::pair<Distribution, size_t>, std::vector<uint64_t>> cache;
+    auto& keys = cache[{d, n}];
+    if (keys.empty()) {
+        if (d == Distribution::ZIPFIAN) {
+            keys = rank_stream(d, n, n);
+            for (auto& k : keys) k = key_of(d, k);
+        } else {
+            keys.resize(n);
+            for (size_t i = 0; i < n; ++i) keys[i] = key_of(d, i);
+        }
+    }
+    return keys;
+}
+
+// The list for the lookup benchmarks and the queries to run on it, built
+// once per (distribution, size). Only the latest is kept, since the larger
+// lists take gigabytes.
+struct LookupFixture {
+    Distribution distribution;
+    size_t n = 0;
+    SkipList<uint64_t> list;
+    std::vector<uint64_t> queries;
+};
+
+const LookupFixture& lookup_fixture(Distribution d, size_t n) {
+    static std::unique_ptr<LookupFixture> fixture;
+    if (!fixture || fixture->distribution != d || fixture->n != n) {
+        fixture.reset();
+        fixture = std::make_unique<LookupFixture>();
+        fixture->distribution = d;
+        fixture->n = n;
+        std::vector<uint64_t> keys(n);
+        for (size_t i = 0; i < n; ++i) keys[i] = key_of(d, i);
+        std::sort(keys.begin(), keys.end());
+        fixture->list.bulk_load(keys.begin(), keys.end());
+        fixture->queries = rank_stream(d, n, QUERIES);
+        for (auto& q : fixture->queries) q = key_of(d, q);
+    }
+    return *fixture;
+}
+
+void skiplist_insert(benchmark::State& state, Distribution d) {
+    size_t n = static_cast<size_t>(state.range(0));
+    const auto& keys = insert_stream(d, n);
+    size_t inserted = 0;
+    for (auto _ : state) {
+        auto list = std::make_unique<SkipList<uint64_t>>();
+        inserted = 0;
+        for (uint64_t k : keys) inserted += list->insert(k);
+        benchmark::DoNotOptimize(inserted);
+        state.PauseTiming();
+        list.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+    state.counters["distinct"] = static_cast<double>(inserted);
+}
+
+void skiplist_contains(benchmark::State& state, Distribution d) {
+    const auto& fixture = lookup_fixture(d, static_cast<size_t>(state.range(0)));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.list.contains(fixture.queries[i]));
+        i = (i + 1) & (QUERIES - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Visits the RANGE_WIDTH elements from each query key on
+void skiplist_range(benchmark::State& state, Distribution d) {
+    const auto& fixture = lookup_fixture(d, static_cast<size_t>(state.range(0)));
+    size_t i = 0;
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        auto it = fixture.list.lower_bound(fixture.queries[i]);
+        for (size_t visited = 0; visited < RANGE_WIDTH && it != fixture.list.end(); ++visited, ++it) sum += *it;
+        benchmark::DoNotOptimize(sum);
+        i = (i + 1) & (QUERIES - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Random metric samples, and random [begin, end) windows over them
+const std::vector<int64_t>& metric_values(size_t n) {
+    static std::map<size_t, std::vector<int64_t>> cache;
+    auto& values = cache[n];
+    if (values.empty()) {
+        uint64_t state = SEED;
+        values.resize(n);
+        for (auto& v : values) v = static_cast<int64_t>(splitmix64(state) % 1000);
+    }
+    return values;
+}
+
+const std::vector<std::pair<size_t, size_t>>& metric_windows(size_t n) {
+    static std::map<size_t, std::vector<std::pair<size_t, size_t>>> cache;
+    auto& windows = cache[n];
+    if (windows.empty()) {
+        uint64_t state = SEED ^ n;
+        windows.resize(QUERIES);
+        for (auto& w : windows) {
+            size_t a = splitmix64(state) % (n + 1), b = splitmix64(state) % (n + 1);
+            w = {std::min(a, b), std::max(a, b)};
+        }
+    }
+    return windows;
+}
+
+using MetricTree = segtree::SegmentTree<segtree::Sum<int64_t>, segtree::Add<segtree::Sum<int64_t>>>;
+
+template<class Tree>
+const Tree& cached_tree(size_t n) {
+    static std::map<size_t, std::unique_ptr<Tree>> cache;
+    auto& tree = cache[n];
+    if (!tree) tree = std::make_unique<Tree>(metric_values(n), std::thread::hardware_concurrency());
+    return *tree;
+}
+
+// state.range(1) is the number of build threads
+template<class Tree>
+void tree_build(benchmark::State& state) {
+    const auto& values = metric_values(static_cast<size_t>(state.range(0)));
+    size_t threads = static_cast<size_t>(state.range(1));
+    for (auto _ : state) {
+        Tree tree(values, threads);
+        benchmark::DoNotOptimize(tree.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void fenwick_prefix_sum(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    const auto& tree = cached_tree<fenwick::FenwickTree<int64_t>>(n);
+    const auto& windows = metric_windows(n);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tree.prefixSum(windows[i].second));
+        i = (i + 1) & (QUERIES - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// The same prefix sums answered BATCH at a time
+void fenwick_prefix_sums(benchmark::State& state) {
+    constexpr size_t BATCH = 64;
+    size_t n = static_cast<size_t>(state.range(0));
+    const auto& tree = cached_tree<fenwick::FenwickTree<int64_t>>(n);
+    std::vector<size_t> counts(QUERIES);
+    for (size_t q = 0; q < QUERIES; ++q) counts[q] = metric_windows(n)[q].second;
+    int64_t sums[BATCH];
+    size_t i = 0;
+    for (auto _ : state) {
+        tree.prefixSums(&counts[i], BATCH, sums);
+        benchmark::DoNotOptimize(sums);
+        i = (i + BATCH) & (QUERIES - 1);
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH);
+}
+
+void segtree_query(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    const auto& tree = cached_tree<MetricTree>(n);
+    const auto& windows = metric_windows(n);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tree.query(windows[i].first, windows[i].second));
+        i = (i + 1) & (QUERIES - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void segtree_update(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    MetricTree tree(metric_values(n), std::thread::hardware_concurrency());
+    const auto& windows = metric_windows(n);
+    size_t i = 0;
+    for (auto _ : state) {
+        tree.update(windows[i].first, windows[i].second, 1);
+        i = (i + 1) & (QUERIES - 1);
+    }
+    benchmark::DoNotOptimize(tree.total());
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Distinct keys in random order
+const std::vector<int>& kinetic_keys(size_t n) {
+    static std::map<size_t, std::vector<int>> cache;
+    auto& keys = cache[n];
+    if (keys.empty()) {
+        keys.resize(n);
+        for (size_t i = 0; i < n; ++i) keys[i] = static_cast<int>(i);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937_64(SEED));
+    }
+    return keys;
+}
+
+void build(KineticHeater& heater, const std::vector<int>& keys) { heater.buildHeater(keys); }
+void build(KineticHanger& hanger, const std::vector<int>& keys) { hanger.buildHanger(keys); }
+
+template<class Structure>
+void kinetic_build(benchmark::State& state) {
+    const auto& keys = kinetic_keys(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto structure = std::make_unique<Structure>();
+        build(*structure, keys);
+        benchmark::DoNotOptimize(structure->size());
+        state.PauseTiming();
+        structure.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Structure>
+void kinetic_insert(benchmark::State& state) {
+    const auto& keys = kinetic_keys(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto structure = std::make_unique<Structure>();
+        for (int k : keys) structure->insert(k);
+        benchmark::DoNotOptimize(structure->size());
+        state.PauseTiming();
+        structure.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Removes every key, in a different order from the one they were built in
+template<class Structure>
+void kinetic_remove(benchmark::State& state) {
+    const auto& keys = kinetic_keys(static_cast<size_t>(state.range(0)));
+    std::vector<int> order(keys.rbegin(), keys.rend());
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto structure = std::make_unique<Structure>();
+        build(*structure, keys);
+        state.ResumeTiming();
+        for (int k : order) structure->remove(k);
+        benchmark::DoNotOptimize(structure->isEmpty());
+        state.PauseTiming();
+        structure.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+struct Corpus {
+    std::string name;
+    std::vector<unsigned char> data;
+};
+
+// Words from a small vocabulary with a skewed choice, so the text has the
+// repeats the transform feeds on.
+std::vector<unsigned char> synthetic_text(size_t n) {
+    static const char* const WORDS[] = {"the", "of", "and", "to", "in", "a", "is", "that", "for", "it",
+                                        "as", "was", "with", "be", "by", "on", "not", "he", "this", "are",
+                                        "or", "his", "from", "at", "which", "but", "have", "an", "had", "they",
+                                        "transform", "block", "suffix", "array", "index", "sorted", "rotation"};
+    constexpr size_t COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+    Zipfian zipf(COUNT, 0.8);
+    uint64_t state = SEED;
+    std::vector<unsigned char> text;
+    text.reserve(n + 16);
+    while (text.size() < n) {
+        const char* word = WORDS[zipf.next(state)];
+        text.insert(text.end(), word, word + std::strlen(word));
+        text.push_back(splitmix64(state) % 12 == 0 ? '\n' : ' ');
+    }
+    text.resize(n);
+    return text;
+}
+
+std::vector<unsigned char> random_bytes(size_t n) {
+    uint64_t state = SEED;
+    std::vector<unsigned char> bytes(n);
+    for (auto& b : bytes) b = static_cast<unsigned char>(splitmix64(state));
+    return bytes;
+}
+
+std::vector<Corpus> load_corpus(const std::string& directory) {
+    std::vector<Corpus> corpus;
+    if (!directory.empty()) {
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (!entry.is_regular_file() || entry.file_size() == 0) continue;
+            std::ifstream in(entry.path(), std::ios::binary);
+            Corpus file{entry.path().filename().string(),
+                        {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()}};
+            corpus.push_back(std::move(file));
+        }
+        if (error) std::fprintf(stderr, "cannot read corpus directory %s: %s\n", directory.c_str(),
+                                error.message().c_str());
+        std::sort(corpus.begin(), corpus.end(), [](const Corpus& a, const Corpus& b) { return a.name < b.name; });
+    }
+    if (corpus.empty()) {
+        constexpr size_t SYNTHETIC_BYTES = 16 * 1024 * 1024;
+        corpus.push_back({"synthetic-text", synthetic_text(SYNTHETIC_BYTES)});
+        corpus.push_back({"synthetic-random", random_bytes(SYNTHETIC_BYTES)});
+    }
+    return corpus;
+}
+
+void bwt_transform(benchmark::State& state, const Corpus* file, size_t blockSize) {
+    bwt::BurrowsWheelerTransform transform(blockSize);
+    std::vector<unsigned char> out(transform.transformedSize(file->data.size()));
+    for (auto _ : state) {
+        long written = transform.transform(file->data.data(), file->data.size(), out.data(), out.size(),
+                                           bwt::XformMethod::WITH_FAST_MTF);
+        if (written < 0) {
+            state.SkipWithError("transform failed");
+            break;
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(file->data.size()));
+    const bwt::BwtStats& stats = transform.stats();
+    if (stats.transformSeconds > 0) state.counters["sort_fraction"] = stats.sortSeconds / stats.transformSeconds;
+}
+
+void bwt_reverse(benchmark::State& state, const Corpus* file, size_t blockSize) {
+    bwt::BurrowsWheelerTransform transform(blockSize);
+    std::vector<unsigned char> encoded(transform.transformedSize(file->data.size()));
+    long written = transform.transform(file->data.data(), file->data.size(), encoded.data(), encoded.size(),
+                                       bwt::XformMethod::WITH_FAST_MTF);
+    if (written < 0) {
+        state.SkipWithError("transform failed");
+        return;
+    }
+    std::vector<unsigned char> decoded(file->data.size());
+    for (auto _ : state) {
+        if (transform.reverseTransform(encoded.data(), static_cast<size_t>(written), decoded.data(),
+                                       decoded.size(), bwt::XformMethod::WITH_FAST_MTF) < 0) {
+            state.SkipWithError("reverse transform failed");
+            break;
+        }
+        benchmark::DoNotOptimize(decoded.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(file->data.size()));
+}
+
+void register_skiplist(int64_t maxElements) {
+    for (Distribution d : {Distribution::UNIFORM, Distribution::ZIPFIAN, Distribution::SORTED}) {
+        std::string suffix = std::string("/") + name_of(d);
+        benchmark::RegisterBenchmark(("SkipList/Insert" + suffix).c_str(), skiplist_insert, d)
+            ->RangeMultiplier(10)->Range(MIN_ELEMENTS, maxElements)->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(("SkipList/Contains" + suffix).c_str(), skiplist_contains, d)
+            ->RangeMultiplier(10)->Range(MIN_ELEMENTS, maxElements);
+        benchmark::RegisterBenchmark(("SkipList/Range" + suffix).c_str(), skiplist_range, d)
+            ->RangeMultiplier(10)->Range(MIN_ELEMENTS, maxElements);
+    }
+}
+
+template<class Structure>
+void register_kinetic(const char* name, int64_t maxElements) {
+    int64_t most = std::min(maxElements, MAX_KINETIC_ELEMENTS);
+    std::string prefix = std::string(name) + "/";
+    benchmark::RegisterBenchmark((prefix + "Build").c_str(), kinetic_build<Structure>)
+        ->RangeMultiplier(10)->Range(MIN_ELEMENTS, most)->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark((prefix + "Insert").c_str(), kinetic_insert<Structure>)
+        ->RangeMultiplier(10)->Range(MIN_ELEMENTS, most)->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark((prefix + "Remove").c_str(), kinetic_remove<Structure>)
+        ->RangeMultiplier(10)->Range(MIN_ELEMENTS, most)->Unit(benchmark::kMillisecond);
+}
+
+void register_range_trees(int64_t maxElements) {
+    // One thread, and every hardware thread if there are more
+    std::vector<int64_t> threads = {1};
+    if (std::thread::hardware_concurrency() > 1) threads.push_back(std::thread::hardware_concurrency());
+    benchmark::RegisterBenchmark("FenwickTree/Build", tree_build<fenwick::FenwickTree<int64_t>>)
+        ->ArgsProduct({benchmark::CreateRange(MIN_ELEMENTS, maxElements, 10), threads})
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark("FenwickTree/PrefixSum", fenwick_prefix_sum)
+        ->RangeMultiplier(10)->Range(MIN_ELEMENTS, maxElements);
+    benchmark::RegisterBenchmark("FenwickTree/PrefixSums", fenwick_prefix_sums)
+        ->RangeMultiplier(10)->Range(MIN_ELEMENTS, maxElements);
+    benchmark::RegisterBenchmark("SegmentTree/Build", tree_build<MetricTree>)
+        ->ArgsProduct({benchmark::CreateRange(MIN_ELEMENTS, maxElements, 10), threads})
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark("SegmentTree/Query", segtree_query)
+        ->RangeMultiplier(10)->Range(MIN_ELEMENTS, maxElements);
+    benchmark::RegisterBenchmark("SegmentTree/Update", segtree_update)
+        ->RangeMultiplier(10)->Range(MIN_ELEMENTS, maxElements);
+}
+
+void register_bwt(const std::vector<Corpus>& corpus) {
+    const size_t blockSizes[] = {bwt::BurrowsWheelerTransform::MIN_BLOCK_SIZE,
+                                 bwt::BurrowsWheelerTransform::DEFAULT_BLOCK_SIZE, 8 * 1024 * 1024};
+    for (const Corpus& file : corpus) {
+        for (size_t blockSize : blockSizes) {
+            // A block larger than the file measures the same as the file
+            if (blockSize > bwt::BurrowsWheelerTransform::MIN_BLOCK_SIZE && blockSize / 2 >= file.data.size()) continue;
+            std::string suffix = "/" + file.name + "/" + std::to_string(blockSize / 1024) + "K";
+            benchmark::RegisterBenchmark(("BWT/Transform" + suffix).c_str(), bwt_transform, &file, blockSize)
+                ->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("BWT/Reverse" + suffix).c_str(), bwt_reverse, &file, blockSize)
+                ->Unit(benchmark::kMillisecond);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+
+    int64_t maxElements = 100000000;
+    const char* environment = std::getenv("BENCH_CORPUS");
+    std::string corpusDirectory = environment ? environment : "";
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--max_elements=", 15) == 0) {
+            maxElements = std::max<int64_t>(MIN_ELEMENTS, std::strtoll(argv[i] + 15, nullptr, 10));
+        } else if (std::strncmp(argv[i], "--corpus=", 9) == 0) {
+            corpusDirectory = argv[i] + 9;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    // Registered cases keep pointers into the corpus
+    static const std::vector<Corpus> corpus = load_corpus(corpusDirectory);
+    register_skiplist(maxElements);
+    register_kinetic<KineticHeater>("KineticHeater", maxElements);
+    register_kinetic<KineticHanger>("KineticHanger", maxElements);
+    register_range_trees(maxElements);
+    register_bwt(corpus);
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}